@@ -5,9 +5,9 @@ import platform
 
 
 # (1)==================== COMMON CONFIGURATION OPTIONS ======================= #
-COMPILER="g++ -g -std=c++17"   # The compiler we want to use 
+COMPILER="g++ -g -std=c++17 -pthread"   # The compiler we want to use 
                                 #(You may try g++ if you have trouble)
-SOURCE="./src/*.cpp ./src/Startup/*.cpp ./src/Particles/*.cpp"    # Where the source code lives
+SOURCE="./src/*.cpp ./src/Startup/*.cpp ./src/Particles/*.cpp ./src/Physics/*.cpp"    # Where the source code lives
 EXECUTABLE="prog"        # Name of the final executable
 # ======================= COMMON CONFIGURATION OPTIONS ======================= #
 
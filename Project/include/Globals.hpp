@@ -11,6 +11,7 @@
 #include <sstream>
 
 #include "../include/Startup/Shader.hpp"
+#include "../include/Startup/FrameUniforms.hpp"
 #include "Camera.hpp"
 
 struct Global {
@@ -22,6 +23,9 @@ struct Global {
 
     Camera gCamera;
 
+    // Camera matrices for the current frame, mirrored in the frame uniform buffer.
+    FrameUniforms gFrameUniforms;
+
     GLuint gGraphicsPipelineShaderProgram;
     GLenum gPolygonMode = GL_LINE;
 };
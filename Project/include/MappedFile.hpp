@@ -0,0 +1,55 @@
+// MappedFile.hpp - Header file for read-only memory-mapped files.
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Maps a whole file read-only into memory. Pages are loaded by the operating system on first
+ * touch, so opening a large file is cheap and only the parts that are read cost memory.
+ */
+class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        // The mapping has a single owner.
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * Maps a file, closing any file mapped before.
+         * 
+         * @param fileName - the path to the file.
+         * @return - whether the file was mapped.
+         */
+        bool Open(const std::string& fileName);
+
+        /**
+         * Unmaps the file. Pointers into it become invalid.
+         */
+        void Close();
+
+        bool IsOpen() const {
+            return m_data != nullptr;
+        }
+
+        const unsigned char* GetData() const {
+            return m_data;
+        }
+
+        size_t GetSize() const {
+            return m_size;
+        }
+
+    private:
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+
+#if defined(MINGW) || defined(_WIN32)
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#else
+        int m_fileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,59 @@
+// Affector.hpp - Header file for the batched particle force affectors.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+#include "Particle.hpp"
+#include "../Physics/FieldVolume.hpp"
+
+enum class AffectorType {
+    Gravity,        // Constant acceleration.
+    LinearDrag,     // Velocity decays exponentially.
+    QuadraticDrag,  // Deceleration proportional to speed squared.
+    Wind,           // Velocity relaxes toward the wind velocity.
+    PointAttractor, // Softened inverse-square pull toward a point; negative strength repels.
+    Vortex,         // Swirl around an axis through a point.
+    Turbulence,     // Acceleration looked up from a precomputed curl-noise volume.
+    FlowField,      // Velocity relaxes toward the velocity stored in a field volume.
+    ForceField      // Acceleration looked up from a field volume.
+};
+
+/**
+ * A force applied to every particle of an emitter. Affectors are plain data: each type is
+ * applied by its own loop over the whole particle span, so there is no per-particle dispatch
+ * and each loop is simple enough for the compiler to vectorize.
+ */
+struct Affector {
+    AffectorType type;
+    glm::vec3 position = glm::vec3(0.0f); // Attractor or vortex center, or turbulence lookup offset, in emitter space.
+    glm::vec3 vector = glm::vec3(0.0f);   // Gravity acceleration, wind velocity, or vortex axis.
+    float strength = 0.0f;                // Drag coefficient, wind or flow coupling, attraction, swirl rate, or field scale.
+    float radius = 0.0f;                  // Radius of influence for attractors and vortices; 0 is unbounded.
+    const FieldVolume<glm::vec3>* field = nullptr; // Volume sampled by field affectors; not owned.
+
+    static Affector Gravity(const glm::vec3& acceleration);
+    static Affector LinearDrag(float coefficient);
+    static Affector QuadraticDrag(float coefficient);
+    static Affector Wind(const glm::vec3& velocity, float coupling);
+    static Affector PointAttractor(const glm::vec3& position, float strength, float radius = 0.0f);
+    static Affector Vortex(const glm::vec3& position, const glm::vec3& axis, float strength, float radius = 0.0f);
+    static Affector Turbulence(const FieldVolume<glm::vec3>* noise, float strength, const glm::vec3& offset = glm::vec3(0.0f));
+    static Affector FlowField(const FieldVolume<glm::vec3>* velocities, float coupling);
+    static Affector ForceField(const FieldVolume<glm::vec3>* forces, float strength = 1.0f);
+};
+
+/**
+ * Applies each affector in order to the velocities of a contiguous span of live particles.
+ * 
+ * @param affectors - the affectors to apply.
+ * @param particles - the first particle of the span.
+ * @param count - the number of particles in the span.
+ * @param deltaTime - seconds elapsed since the last update.
+ */
+void ApplyAffectors(const std::vector<Affector>& affectors, Particle* particles, int count, float deltaTime);
+
+/**
+ * Adds a constant acceleration to the velocities of a span of particles.
+ */
+void ApplyGravity(Particle* particles, int count, const glm::vec3& acceleration, float deltaTime);
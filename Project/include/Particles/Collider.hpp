@@ -0,0 +1,60 @@
+// Collider.hpp - Header file for the batched particle colliders.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+#include "Particle.hpp"
+
+enum class ColliderType {
+    Plane,  // Infinite plane; particles are kept on the side the normal points to.
+    Sphere, // Solid sphere.
+    Box     // Solid oriented box.
+};
+
+/**
+ * A static obstacle for an emitter's particles, in emitter space. Like affectors, colliders are
+ * plain data and each type is tested by its own loop over the whole particle span after integration.
+ */
+struct Collider {
+    ColliderType type;
+    glm::vec3 position = glm::vec3(0.0f);    // A point on the plane, or the sphere or box center.
+    glm::vec3 normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 halfExtents = glm::vec3(0.0f); // Box half size along its local axes.
+    glm::mat3 rotation = glm::mat3(1.0f);    // Box local axes as columns.
+    float radius = 0.0f;
+    float restitution = 0.5f;                // Fraction of normal speed kept after a bounce.
+    float friction = 0.2f;                   // Fraction of tangential speed removed per contact.
+    bool killOnContact = false;              // Retire particles that touch the collider instead of bouncing.
+
+    static Collider Plane(const glm::vec3& point, const glm::vec3& normal, float restitution = 0.5f, float friction = 0.2f);
+    static Collider Sphere(const glm::vec3& center, float radius, float restitution = 0.5f, float friction = 0.2f);
+    static Collider Box(const glm::vec3& center, const glm::vec3& halfExtents, const glm::mat3& rotation = glm::mat3(1.0f),
+                        float restitution = 0.5f, float friction = 0.2f);
+};
+
+/**
+ * Bounces a particle off a surface it touches, shared by every kind of collider. If the particle
+ * is still moving into the surface, the normal velocity is reflected and scaled by the
+ * restitution, the tangential velocity is damped by the friction, and the particle is flagged as
+ * collided. The caller moves the particle out of the surface.
+ * 
+ * @param p - the particle.
+ * @param normal - the unit surface normal, pointing out of the solid.
+ * @param restitution - fraction of normal speed kept after the bounce.
+ * @param friction - fraction of tangential speed removed.
+ */
+void ResolveContact(Particle& p, const glm::vec3& normal, float restitution, float friction);
+
+/**
+ * Pushes particles out of each collider and reflects their velocities. Particles touching a
+ * kill-on-contact collider get their life set to zero so the caller can retire them.
+ * 
+ * @param colliders - the colliders to test.
+ * @param particles - the first particle of the span.
+ * @param count - the number of particles in the span.
+ * @param firstKillable - kill-on-contact colliders only test particles from this index on, so
+ *                        particles that cannot be retired (like linked ones) pass through them.
+ * @return - the number of particles that touched a kill-on-contact collider.
+ */
+int ApplyColliders(const std::vector<Collider>& colliders, Particle* particles, int count, int firstKillable = 0);
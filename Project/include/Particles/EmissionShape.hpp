@@ -0,0 +1,102 @@
+// EmissionShape.hpp - Header file for the shapes particles are spawned from.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <string>
+#include <vector>
+
+enum class EmissionShapeType {
+    Cone,        // From a point, within an angle of the axis. The default fountain.
+    Sphere,      // From inside a ball, or its surface, outward.
+    Hemisphere,  // Like the sphere, but only the half facing along the axis.
+    Box,         // From inside an axis-aligned box, along the axis.
+    Disc,        // From a disc facing the axis, along the axis.
+    Line,        // From a segment, along the axis.
+    MeshSurface  // From a triangle mesh's surface, along the surface normal.
+};
+
+/**
+ * Triangles to spawn particles on. An area-weighted cumulative distribution over the triangles
+ * is built once, so each sample is a binary search plus a random point in one triangle.
+ */
+class EmissionMesh {
+    public:
+        /**
+         * Loads the triangles of an OBJ file.
+         * 
+         * @param fileName - path to the OBJ file.
+         * @param transform - transform from the file's space into emitter space.
+         * @return - whether the file was loaded.
+         */
+        bool LoadOBJ(const std::string& fileName, const glm::mat4& transform = glm::mat4(1.0f));
+
+        /**
+         * Replaces the mesh with the given triangles and rebuilds the sampling table.
+         * 
+         * @param vertices - triangle vertices in emitter space.
+         * @param indices - three vertex indices per triangle.
+         */
+        void SetTriangles(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices);
+
+        /**
+         * Picks a uniformly distributed point on the surface.
+         * 
+         * @param position - receives the point.
+         * @param normal - receives the normal of the triangle the point is on.
+         */
+        void Sample(glm::vec3& position, glm::vec3& normal) const;
+
+        bool IsEmpty() const {
+            return m_cumulativeArea.empty();
+        }
+
+        float GetSurfaceArea() const {
+            return m_cumulativeArea.empty() ? 0.0f : m_cumulativeArea.back();
+        }
+
+    private:
+        // A triangle as a vertex, two edges and its unit normal.
+        struct Triangle {
+            glm::vec3 v0, e1, e2, normal;
+        };
+
+        std::vector<Triangle> m_triangles;
+        // Running total of the triangles' areas; triangle i covers (m_cumulativeArea[i - 1], m_cumulativeArea[i]].
+        std::vector<float> m_cumulativeArea;
+};
+
+/**
+ * Where an emitter spawns particles and which way they leave. Like affectors and colliders, shapes
+ * are plain data built by the factories below. Particles start at speed along the shape's direction,
+ * plus the emitter's random spread.
+ */
+struct EmissionShape {
+    EmissionShapeType type = EmissionShapeType::Cone;
+    glm::vec3 position = glm::vec3(0.0f);      // Center, apex or line start, in emitter space.
+    glm::vec3 axis = glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 halfExtents = glm::vec3(0.0f);   // Box half extents.
+    glm::vec3 end = glm::vec3(0.0f);           // Line end.
+    float radius = 0.0f;
+    float angle = 0.0f;                        // Cone half angle in radians.
+    float speed = 10.0f;
+    bool surface = false;                      // Spheres and hemispheres spawn on their shells only.
+    const EmissionMesh* mesh = nullptr;        // Not owned.
+
+    static EmissionShape Cone(const glm::vec3& apex = glm::vec3(0.0f), const glm::vec3& axis = glm::vec3(0.0f, 1.0f, 0.0f),
+                              float angle = 0.0f, float speed = 10.0f);
+    static EmissionShape Sphere(const glm::vec3& center, float radius, float speed, bool surface = false);
+    static EmissionShape Hemisphere(const glm::vec3& center, const glm::vec3& axis, float radius, float speed, bool surface = false);
+    static EmissionShape Box(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& axis, float speed);
+    static EmissionShape Disc(const glm::vec3& center, const glm::vec3& axis, float radius, float speed);
+    static EmissionShape Line(const glm::vec3& start, const glm::vec3& end, const glm::vec3& axis, float speed);
+    static EmissionShape MeshSurface(const EmissionMesh* mesh, float speed);
+};
+
+/**
+ * Picks a spawn position and launch direction on a shape.
+ * 
+ * @param shape - the shape to sample.
+ * @param position - receives the spawn position, in emitter space.
+ * @param direction - receives the unit launch direction.
+ */
+void SampleEmissionShape(const EmissionShape& shape, glm::vec3& position, glm::vec3& direction);
@@ -0,0 +1,40 @@
+// EmitterDrawData.hpp - Header file for the GPU-side layouts of particle draws.
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/**
+ * Layout of a single command in the indirect draw buffer (matches the OpenGL spec).
+ */
+struct DrawArraysIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+};
+
+/**
+ * Per-draw data read by the particle shader through gl_DrawID. The model-view-projection and the
+ * camera's billboard axes are computed once per emitter per frame instead of once per vertex.
+ */
+struct EmitterDrawData {
+    glm::mat4 modelViewProjectionMatrix;
+    glm::vec4 cameraRight; // Camera right vector in emitter space.
+    glm::vec4 cameraUp;    // Camera up vector in emitter space.
+    GLint lifetimeCurve;   // The emitter's curves in the lifetime curve table, or -1 without curves.
+    GLint padding[3];
+};
+
+/**
+ * Per-draw data read by the trail shader through gl_DrawID. Each instance of a trail draw is one
+ * particle's ribbon, whose points start at firstPoint + gl_InstanceID * pointsPerTrail.
+ */
+struct TrailDrawData {
+    glm::mat4 modelViewProjectionMatrix;
+    glm::vec4 cameraForward; // Camera view direction in emitter space; ribbons widen across it.
+    GLint firstPoint;
+    GLint pointsPerTrail;
+    GLfloat width;           // Ribbon width at the particle, relative to the particle's size.
+    GLint blendMode;
+};
@@ -0,0 +1,184 @@
+// EmitterManager.hpp - Header file for the emitter manager class.
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+#include "EmitterDrawData.hpp"
+#include "ParticleEmitter.hpp"
+#include "GPUParticleEmitter.hpp"
+#include "WeightedBlendedOIT.hpp"
+#include "../Physics/GridFluidSolver.hpp"
+#include "../Startup/Shader.hpp"
+
+class EmitterManager {
+    public:
+        EmitterManager();
+        ~EmitterManager();
+
+        /**
+         * Creates a new emitter that is simulated and rendered by this manager.
+         * 
+         * @param position - the emitter's position in world space.
+         * @param maxParticles - the number of particle slots the emitter owns.
+         * @return - a pointer to the new emitter, owned by the manager.
+         */
+        ParticleEmitter* CreateEmitter(const glm::vec3& position, int maxParticles = 100000);
+
+        /**
+         * Removes and deletes an emitter owned by this manager.
+         * 
+         * @param emitter - the emitter to destroy.
+         */
+        void DestroyEmitter(ParticleEmitter* emitter);
+
+        /**
+         * Creates a new emitter whose particles are simulated by a compute pass and never read back.
+         * 
+         * @param position - the emitter's position in world space.
+         * @param maxParticles - the number of particle slots the emitter owns.
+         * @return - a pointer to the new emitter, owned by the manager.
+         */
+        GPUParticleEmitter* CreateGPUEmitter(const glm::vec3& position, int maxParticles = 100000);
+
+        /**
+         * Removes and deletes a GPU emitter owned by this manager.
+         * 
+         * @param emitter - the emitter to destroy.
+         */
+        void DestroyGPUEmitter(GPUParticleEmitter* emitter);
+
+        /**
+         * Creates a grid fluid that is stepped once per update, before any emitter. Emitters follow
+         * it through a FlowField affector on its velocity volume.
+         * 
+         * @param settings - the grid's resolution, placement and solver parameters.
+         * @return - a pointer to the new fluid, owned by the manager.
+         */
+        GridFluidSolver* CreateGridFluid(const GridFluidSettings& settings = GridFluidSettings());
+
+        /**
+         * Removes and deletes a grid fluid. Affectors that sample it must be removed first.
+         * 
+         * @param fluid - the fluid to destroy.
+         */
+        void DestroyGridFluid(GridFluidSolver* fluid);
+
+        /**
+         * Updates every emitter and packs their visible particles into the shared staging buffers.
+         * 
+         * @param frustumCulling - A boolean value used to decide if frustum culling is turned on/off.
+         */
+        void UpdateEmitters(bool frustumCulling);
+
+        /**
+         * Uploads all particle data and renders every emitter with one indirect multi-draw per blend mode.
+         */
+        void RenderEmitters();
+
+        const std::vector<ParticleEmitter*>& GetEmitters() {
+            return m_emitters;
+        }
+
+        const std::vector<GPUParticleEmitter*>& GetGPUEmitters() {
+            return m_gpuEmitters;
+        }
+
+        /**
+         * Returns the number of CPU-simulated particles rendered; GPU emitters' counts stay on the GPU.
+         */
+        int GetNumParticlesRendered();
+
+        /**
+         * Switches between sorted alpha blending and weighted blended order-independent transparency.
+         * The OIT mode needs no per-frame sort or camera distances.
+         */
+        void ToggleOrderIndependentTransparency() {
+            m_orderIndependentTransparency = !m_orderIndependentTransparency;
+        }
+
+        bool IsOrderIndependentTransparencyEnabled() {
+            return m_orderIndependentTransparency;
+        }
+
+    private:
+        void InitializeBuffers();
+
+        void ReserveInstances(int numInstances);
+
+        void ReserveDraws(int numDraws);
+
+        void ReserveTrailPoints(int numPoints);
+
+        void DrawTrails();
+
+        void UpdateLifetimeCurveTexture();
+
+        EmitterDrawData GetEmitterDrawData(const glm::mat4& modelMatrix);
+
+        void DrawBlendModeGroup(BlendMode blendMode, Shader* shader);
+
+        void DrawGPUEmitters(BlendMode blendMode, Shader* shader);
+
+        void BindSharedBuffers();
+
+        void CaptureSceneDepth();
+
+        std::vector<ParticleEmitter*> m_emitters;
+        std::vector<GPUParticleEmitter*> m_gpuEmitters;
+        std::vector<GridFluidSolver*> m_gridFluids;
+
+        // CPU staging for every emitter's visible particles, packed back to back.
+        std::vector<float> m_gpuParticleData;
+        std::vector<unsigned char> m_gpuParticleColorData;
+        std::vector<float> m_gpuParticleAgeData;
+        std::vector<DrawArraysIndirectCommand> m_drawCommands;
+        std::vector<EmitterDrawData> m_drawData;
+
+        // Trail points of every visible particle with a trail, and one ribbon draw per emitter.
+        std::vector<glm::vec4> m_trailPointData;
+        std::vector<DrawArraysIndirectCommand> m_trailCommands;
+        std::vector<TrailDrawData> m_trailDrawData;
+        int m_trailPointCount = 0;
+        int m_trailPointCapacity = 0;
+        int m_trailDrawCapacity = 0;
+
+        // Every emitter's lifetime curves, baked into two rows each of a 1D texture array. The
+        // emitters and curve revisions it was baked from tell when it must be rebaked.
+        GLuint m_lifetimeCurveTexture = 0;
+        std::vector<std::pair<const ParticleEmitter*, unsigned int>> m_bakedLifetimeCurves;
+
+        // Draws are grouped by blend mode; each group is a contiguous range of the buffers above.
+        struct PendingDraw {
+            DrawArraysIndirectCommand command;
+            EmitterDrawData data;
+            float cameraDistance;
+        };
+        std::vector<PendingDraw> m_pendingDraws[(int)BlendMode::Count];
+        int m_groupFirstDraw[(int)BlendMode::Count];
+        int m_groupDrawCount[(int)BlendMode::Count];
+        int m_particleRenderCount = 0;
+
+        Shader* m_particleShader;
+        GLuint m_shaderProgram;
+        Shader* m_particleOITShader;
+        GLuint m_oitShaderProgram;
+        WeightedBlendedOIT* m_oit;
+        Shader* m_gpuParticleShader;
+        Shader* m_trailShader;
+        SceneDepth m_sceneDepth;
+        int m_sceneDepthWidth = 0;
+        int m_sceneDepthHeight = 0;
+        bool m_orderIndependentTransparency = false;
+        GLuint m_VAO;
+        GLuint m_positionBuffer, m_colorBuffer, m_ageBuffer;
+        GLuint m_indirectBuffer, m_emitterDataBuffer;
+        GLuint m_trailPointBuffer, m_trailIndirectBuffer, m_trailDataBuffer;
+        int m_instanceCapacity = 0;
+        int m_drawCapacity = 0;
+
+        std::chrono::steady_clock::time_point m_lastTime;
+};
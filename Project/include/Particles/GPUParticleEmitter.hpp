@@ -0,0 +1,109 @@
+// GPUParticleEmitter.hpp - Header file for emitters whose particles live and update on the GPU.
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "EmitterDrawData.hpp"
+#include "ParticleEmitter.hpp"
+#include "../Startup/Shader.hpp"
+
+struct GPUParticleSettings {
+    glm::vec3 gravity = glm::vec3(0.0f, -5.25f, 0.0f); // Same effective gravity as the CPU fountain.
+    float spread = 2.0f;
+    float emissionRate = 10000.0f;                      // Particles spawned per second.
+
+    bool depthCollision = true;
+    float collisionThickness = 0.5f; // How far behind the stored depth a particle still collides.
+    float restitution = 0.4f;
+    float friction = 0.2f;
+};
+
+/**
+ * Scene depth captured by the EmitterManager after the opaque pass, with the matrices it was
+ * rendered with. GPU emitters read last frame's capture, so they never collide with themselves.
+ */
+struct SceneDepth {
+    GLuint texture = 0;
+    glm::mat4 viewMatrix = glm::mat4(1.0f);
+    glm::mat4 projectionMatrix = glm::mat4(1.0f);
+    bool valid = false;
+};
+
+/**
+ * An emitter whose particle state never leaves the GPU. A compute pass spawns, ages and integrates
+ * the particles, optionally collides them with the scene depth buffer, and appends the live ones to
+ * the emitter's draw by atomically incrementing the indirect command's instance count.
+ */
+class GPUParticleEmitter {
+    public:
+        GPUParticleEmitter(const glm::vec3& position, int maxParticles = 100000);
+        ~GPUParticleEmitter();
+
+        /**
+         * Dispatches the update for this frame. The results are ready for Draw() after a
+         * command and storage barrier.
+         * 
+         * @param computeShader - the shared GPUParticles.comp program.
+         * @param deltaTime - seconds elapsed since the last update.
+         * @param sceneDepth - the depth captured last frame.
+         */
+        void Update(Shader* computeShader, float deltaTime, const SceneDepth& sceneDepth);
+
+        /**
+         * Binds the emitter's particle and draw data and issues its indirect draw. The particle shader
+         * must already be in use with u_BlendMode set.
+         * 
+         * @param drawData - the emitter's camera data for this frame.
+         */
+        void Draw(Shader* shader, const EmitterDrawData& drawData);
+
+        void SetPosition(const glm::vec3& position) {
+            m_emitterPosition = position;
+            m_modelMatrix = glm::translate(glm::mat4(1.0f), position);
+        }
+
+        glm::mat4 GetModelMatrix() {
+            return m_modelMatrix;
+        }
+
+        glm::vec3 GetPosition() {
+            return m_emitterPosition;
+        }
+
+        int GetMaxParticles() {
+            return m_maxParticles;
+        }
+
+        /**
+         * GPU particles are never sorted, so only order-independent blend modes look right outside OIT.
+         */
+        BlendMode GetBlendMode() {
+            return m_blendMode;
+        }
+
+        void SetBlendMode(BlendMode blendMode) {
+            m_blendMode = blendMode;
+        }
+
+        GPUParticleSettings& GetSettings() {
+            return m_settings;
+        }
+
+    private:
+        glm::vec3 m_emitterPosition;
+        glm::mat4 m_modelMatrix;
+        int m_maxParticles;
+        BlendMode m_blendMode = BlendMode::Additive;
+        GPUParticleSettings m_settings;
+
+        // Fractional spawns carried to the next frame so low rates still emit.
+        float m_spawnRemainder = 0.0f;
+        unsigned int m_frame = 0;
+
+        GLuint m_stateBuffer = 0;
+        GLuint m_positionBuffer = 0;
+        GLuint m_colorBuffer = 0;
+        GLuint m_commandBuffer = 0;
+        GLuint m_emitterDataBuffer = 0;
+};
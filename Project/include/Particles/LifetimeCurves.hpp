@@ -0,0 +1,50 @@
+// LifetimeCurves.hpp - Header file for color and size curves over a particle's life.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+// Samples per curve in the baked lookup table.
+static const int LIFETIME_CURVE_RESOLUTION = 256;
+
+/**
+ * Piecewise linear curves over a particle's normalized age, from 0 at spawn to 1 at death. The
+ * color curve multiplies the particle's spawn color and the size curve its spawn size. The curves
+ * are baked into a lookup table and evaluated in the vertex shader, so particles' colors and sizes
+ * change over their lives without any per-particle work on the CPU.
+ */
+struct LifetimeCurves {
+    struct ColorKey {
+        float age;
+        glm::vec4 color;
+    };
+
+    struct SizeKey {
+        float age;
+        float size;
+    };
+
+    std::vector<ColorKey> colorKeys; // No keys leaves the color unchanged.
+    std::vector<SizeKey> sizeKeys;   // No keys leaves the size unchanged.
+
+    bool IsEmpty() const {
+        return colorKeys.empty() && sizeKeys.empty();
+    }
+
+    /**
+     * Sorts the keys by age, which evaluation relies on.
+     */
+    void SortKeys();
+
+    glm::vec4 EvaluateColor(float age) const;
+
+    float EvaluateSize(float age) const;
+
+    /**
+     * Samples both curves at LIFETIME_CURVE_RESOLUTION evenly spaced ages, from 0 to 1 inclusive.
+     * 
+     * @param colorTexels - receives the color curve.
+     * @param sizeTexels - receives the size curve, repeated in every channel.
+     */
+    void Bake(glm::vec4* colorTexels, glm::vec4* sizeTexels) const;
+};
@@ -8,8 +8,11 @@ struct Particle {
     glm::vec3 pos, speed;
     unsigned char r, g, b, a;
     float size, angle, weight, life, cameraDistance;
+    float lifetime = 0.0f; // Life at spawn, which normalizes the particle's age.
     glm::vec3 velocity;
     bool isVisible = true;
+    bool collided = false; // Set by colliders on impact, cleared when collision events are gathered.
+    int trail = -1;        // Slot of this particle's trail history, or -1 without one.
 
     // Operator for comparing particles when sorting.
     bool operator<(const Particle& that) const {
@@ -5,27 +5,205 @@
 #include <glm/gtc/random.hpp>
 #include <glad/glad.h>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
+#include <cstdint>
 #include <ctime>
 #include <cmath>
 
 #include "Particle.hpp"
+#include "Affector.hpp"
+#include "Collider.hpp"
+#include "ParticleEvents.hpp"
+#include "EmissionShape.hpp"
+#include "PointCloud.hpp"
+#include "LifetimeCurves.hpp"
+#include "../Physics/SpatialGrid.hpp"
+#include "../Physics/SPHSolver.hpp"
+#include "../Physics/BoidsSolver.hpp"
+#include "../Physics/BarnesHutTree.hpp"
+#include "../Physics/MeshCollider.hpp"
+#include "../Physics/SDFCollider.hpp"
+#include "../Physics/ConstraintSolver.hpp"
+
+/**
+ * How an emitter's particles are blended. The values match u_BlendMode in the particle shaders.
+ */
+enum class BlendMode {
+    Alpha = 0,         // Straight alpha, sorted back to front.
+    Additive = 1,      // Order independent, never sorted.
+    Premultiplied = 2, // Colors are premultiplied at spawn, sorted back to front.
+    Opaque = 3,        // Depth tested and written, never sorted.
+    Count = 4
+};
+
+/**
+ * How an emitter moves its particles after forces are applied.
+ */
+enum class SimulationMode {
+    Ballistic = 0, // Independent particles integrated with gravity and affectors.
+    SPH = 1,       // Smoothed-particle hydrodynamics fluid.
+    Boids = 2,     // Flocking steering on top of gravity and affectors.
+    NBody = 3,     // Mutual Barnes-Hut gravity in place of the uniform gravity vector.
+    Count = 4
+};
+
+class ParticleEmitter;
+
+/**
+ * Makes an emitter spawn a burst at every event of another emitter, e.g. sparks where fireworks
+ * die or droplets where rain hits the ground.
+ */
+struct SubEmitterSource {
+    ParticleEmitter* parent;
+    ParticleEventType trigger;
+    int particlesPerEvent;
+    float speed;           // Burst particles leave in random directions at up to this speed.
+    float inheritVelocity; // Fraction of the parent particle's velocity added to the burst.
+};
 
 class ParticleEmitter {
     public:
-        ParticleEmitter();
+        ParticleEmitter(const glm::vec3& position = glm::vec3(0.0f, 0.0f, -5.0f), int maxParticles = 100000);
         ~ParticleEmitter();
 
-        void InitializeBuffers();
-
         int FindUnusedParticle();
 
+        void KillParticle(int index);
+
         void GenerateRandomParticles(int numParticles);
 
-        void UpdateParticles(bool frustumCulling);
+        /**
+         * Sets where new particles spawn and which way they leave. The default is an upward point
+         * fountain.
+         */
+        void SetEmissionShape(const EmissionShape& shape) {
+            m_emissionShape = shape;
+        }
+
+        EmissionShape& GetEmissionShape() {
+            return m_emissionShape;
+        }
+
+        /**
+         * Spawns particles at the points [first, first + count) of a point cloud, in order, instead of
+         * on the emission shape. A cursor walks the range and wraps around, so consecutive updates
+         * continue where the last one stopped. Particles take the cloud's colors if it has any and
+         * still leave along the shape's direction, so a shape speed and spread of 0 keep them still.
+         * The cloud is not owned by the emitter; pass nullptr to go back to the shape.
+         */
+        void SetPointCloud(const PointCloud* pointCloud, size_t first = 0, size_t count = SIZE_MAX);
+
+        /**
+         * The index of the next point cloud point to spawn.
+         */
+        size_t GetPointCloudCursor() {
+            return m_pointCloudCursor;
+        }
 
-        void RenderParticles();
+        /**
+         * Sets the color and size curves applied over particles' lives. Empty curves turn them off.
+         */
+        void SetLifetimeCurves(const LifetimeCurves& curves);
+
+        const LifetimeCurves& GetLifetimeCurves() {
+            return m_lifetimeCurves;
+        }
+
+        bool HasLifetimeCurves() {
+            return !m_lifetimeCurves.IsEmpty();
+        }
+
+        /**
+         * Changes whenever the curves are set, so a baked copy can tell when it is out of date.
+         */
+        unsigned int GetLifetimeCurvesRevision() {
+            return m_lifetimeCurvesRevision;
+        }
+
+        /**
+         * Sets the range new particles' lifetimes are drawn from, in seconds.
+         */
+        void SetLifetime(float minLife, float maxLife) {
+            m_minLife = minLife;
+            m_maxLife = std::max(minLife, maxLife);
+        }
+
+        /**
+         * Sets how many particles the emitter spawns per second on its own. Sub-emitters that should
+         * only spawn bursts use a rate of 0.
+         */
+        void SetEmissionRate(float particlesPerSecond) {
+            m_emissionRate = std::max(0.0f, particlesPerSecond);
+        }
+
+        float GetEmissionRate() {
+            return m_emissionRate;
+        }
+
+        /**
+         * Sets how many events of a type are kept per update. The buffer is allocated here, once,
+         * and a capacity of 0 turns recording off.
+         */
+        void SetEventCapacity(ParticleEventType type, int capacity) {
+            m_events[(int)type].SetCapacity(capacity);
+        }
+
+        /**
+         * The events recorded by the last update. They stay valid until the next update begins.
+         */
+        const ParticleEventBuffer& GetEvents(ParticleEventType type) const {
+            return m_events[(int)type];
+        }
+
+        /**
+         * Gives every particle a ribbon through its last positions. Each particle owns a ring of
+         * length points in one contiguous array, and all rings advance together every sampleInterval
+         * seconds. A length below 2 turns trails off.
+         * 
+         * @param length - the number of points in each trail, including the particle's position.
+         * @param width - the ribbon's width at the particle, relative to the particle's size.
+         * @param sampleInterval - seconds between stored points.
+         */
+        void EnableTrails(int length, float width = 0.5f, float sampleInterval = 1.0f / 60.0f);
+
+        int GetTrailLength() {
+            return m_trailLength;
+        }
+
+        float GetTrailWidth() {
+            return m_trailWidth;
+        }
+
+        /**
+         * Spawns bursts from another emitter's events, turning on its event recording if needed.
+         */
+        void AddSubEmitterSource(const SubEmitterSource& source);
+
+        /**
+         * Stops spawning from a parent's events, e.g. before the parent is destroyed.
+         */
+        void RemoveSubEmitterSources(const ParticleEmitter* parent);
+
+        /**
+         * Simulates the emitter for one frame and packs the visible particles for the GPU.
+         * 
+         * @param deltaTime - seconds elapsed since the last update.
+         * @param frustumCulling - A boolean value used to decide if frustum culling is turned on/off.
+         * @param sortParticles - whether particles must be sorted back to front for alpha blending.
+         * @param viewProjectionMatrix - the camera's view-projection matrix used for culling.
+         * @param gpuParticleData - destination for 4 floats (position, size) per visible particle.
+         * @param gpuParticleColorData - destination for 4 bytes (rgba) per visible particle.
+         * @param gpuTrailData - destination for GetTrailLength() points per visible particle, oldest
+         *                       first. Unused when trails are off.
+         * @param gpuParticleAgeData - destination for 1 float (normalized age) per visible particle.
+         *                             Unused without lifetime curves.
+         * @return - the number of particles written.
+         */
+        int UpdateParticles(float deltaTime, bool frustumCulling, bool sortParticles, const glm::mat4& viewProjectionMatrix,
+                            float* gpuParticleData, unsigned char* gpuParticleColorData, glm::vec4* gpuTrailData,
+                            float* gpuParticleAgeData);
 
         glm::mat4 GetModelMatrix() {
             return m_modelMatrix;
@@ -35,6 +213,122 @@ class ParticleEmitter {
             return m_emitterPosition;
         }
 
+        void SetPosition(const glm::vec3& position) {
+            m_emitterPosition = position;
+            m_modelMatrix = glm::translate(glm::mat4(1.0f), position);
+        }
+
+        int GetMaxParticles() {
+            return m_maxParticles;
+        }
+
+        BlendMode GetBlendMode() {
+            return m_blendMode;
+        }
+
+        void SetBlendMode(BlendMode blendMode) {
+            m_blendMode = blendMode;
+        }
+
+        /**
+         * Only straight and premultiplied alpha blending depend on draw order.
+         */
+        bool RequiresSorting() {
+            return m_blendMode == BlendMode::Alpha || m_blendMode == BlendMode::Premultiplied;
+        }
+
+        /**
+         * Adds a force to this emitter's affector pipeline. Affectors run in the order they were added,
+         * after the emitter's gravity.
+         */
+        void AddAffector(const Affector& affector) {
+            m_affectors.push_back(affector);
+        }
+
+        std::vector<Affector>& GetAffectors() {
+            return m_affectors;
+        }
+
+        /**
+         * Adds an obstacle that particles bounce off, or die on, after they move each update.
+         */
+        void AddCollider(const Collider& collider) {
+            m_colliders.push_back(collider);
+        }
+
+        std::vector<Collider>& GetColliders() {
+            return m_colliders;
+        }
+
+        /**
+         * Adds a triangle mesh that particles collide with. The mesh is not owned by the emitter
+         * and may be shared between emitters.
+         */
+        void AddMeshCollider(const MeshCollider* meshCollider) {
+            m_meshColliders.push_back(meshCollider);
+        }
+
+        /**
+         * Adds a signed distance field that particles collide with. Like meshes, fields are not
+         * owned by the emitter.
+         */
+        void AddSDFCollider(const SDFCollider* sdfCollider) {
+            m_sdfColliders.push_back(sdfCollider);
+        }
+
+        /**
+         * Rebuilds a spatial grid over the live particles at the end of every update so neighbors
+         * within radius can be queried. A radius of 0 turns the grid off.
+         */
+        void EnableNeighborQueries(float radius) {
+            m_neighborRadius = radius;
+        }
+
+        /**
+         * Returns the grid built at the end of the last update, whose indices match the live
+         * particles as they were left for drawing. It is only valid while neighbor queries are on.
+         */
+        const SpatialGrid& GetSpatialGrid() const {
+            return m_spatialGrid;
+        }
+
+        SimulationMode GetSimulationMode() {
+            return m_simulationMode;
+        }
+
+        void SetSimulationMode(SimulationMode simulationMode) {
+            m_simulationMode = simulationMode;
+        }
+
+        SPHSettings& GetSPHSettings() {
+            return m_sphSolver.GetSettings();
+        }
+
+        BoidsSettings& GetBoidsSettings() {
+            return m_boidsSolver.GetSettings();
+        }
+
+        NBodySettings& GetNBodySettings() {
+            return m_barnesHutTree.GetSettings();
+        }
+
+        int AddRope(const glm::vec3& start, const glm::vec3& end, int segments, bool pinStart = true, bool pinEnd = false);
+
+        /**
+         * Moves a linked particle, e.g. to drag a pinned rope end along with something.
+         */
+        void SetLinkedParticlePosition(int index, const glm::vec3& position) {
+            m_particles[index].pos = position;
+        }
+
+        ConstraintSettings& GetConstraintSettings() {
+            return m_constraintSolver.GetSettings();
+        }
+
+        int GetNumParticlesAlive() {
+            return m_aliveCount;
+        }
+
         void SortParticles();
 
         void GetFrustumPlanes(const glm::mat4& viewProjectionMatrix);
@@ -60,21 +354,69 @@ class ParticleEmitter {
         }
 
     private:
-        glm::vec3 m_emitterPosition = glm::vec3(0.0f);
-        Particle m_particles[100000];
-        int m_maxParticles = 100000;
-        int m_lastUsedParticle = 0;
+        void InitializeParticle(Particle& particle, const glm::vec3& position, const glm::vec3& velocity);
+
+        void SetParticleColor(Particle& particle, unsigned char r, unsigned char g, unsigned char b, unsigned char a);
+
+        void EmitSubEmitterBursts();
+
+        void ResetTrail(int trail, const glm::vec3& position);
+
+        void ReleaseTrail(Particle& particle);
+
+        void AdvanceTrails(float deltaTime);
+
+        glm::vec3 m_emitterPosition;
+        std::vector<Particle> m_particles;
+        int m_maxParticles;
+        int m_aliveCount = 0;  // Live particles occupy [0, m_aliveCount).
+        int m_linkedCount = 0; // Rope particles occupy [0, m_linkedCount) and never move slots.
         int m_particleRenderCount = 0;
-        float deltaTime = 0;
-        glm::mat4 m_viewProjectionMatrix;
 
-        GLuint m_VAO, m_VBO, m_instanceVBO;
-        GLuint m_positionBuffer, m_colorBuffer;
-        GLuint m_shaderProgram;
         glm::vec3 m_gravity = glm::vec3(0.0f, -10.5f, 0.0f);
         float m_spread = 2.0f;
+        float m_emissionRate = 10000.0f;
+        EmissionShape m_emissionShape;
+        float m_minLife = 0.5f;
+        float m_maxLife = 5.0f;
+        LifetimeCurves m_lifetimeCurves;
+        unsigned int m_lifetimeCurvesRevision = 0;
+
+        const PointCloud* m_pointCloud = nullptr;
+        size_t m_pointCloudFirst = 0;
+        size_t m_pointCloudEnd = 0;
+        size_t m_pointCloudCursor = 0;
+        float m_emissionAccumulator = 0.0f;
+        std::vector<Affector> m_affectors;
+        std::vector<Collider> m_colliders;
+        std::vector<const MeshCollider*> m_meshColliders;
+        std::vector<const SDFCollider*> m_sdfColliders;
+        // Where each live particle was before this update's integration, for swept mesh collision.
+        std::vector<glm::vec3> m_previousPositions;
+
+        ParticleEventBuffer m_events[(int)ParticleEventType::Count];
+        std::vector<SubEmitterSource> m_subEmitterSources;
+
+        // Trail rings, m_trailLength points per slot, all sharing one write position.
+        std::vector<glm::vec4> m_trailPoints;
+        std::vector<int> m_freeTrails;
+        int m_trailLength = 0;
+        int m_trailHead = 0;
+        float m_trailWidth = 0.5f;
+        float m_trailSampleInterval = 1.0f / 60.0f;
+        float m_trailTimer = 0.0f;
+
+        SpatialGrid m_spatialGrid;
+        float m_neighborRadius = 0.0f;
+
+        SimulationMode m_simulationMode = SimulationMode::Ballistic;
+        SPHSolver m_sphSolver;
+        BoidsSolver m_boidsSolver;
+        BarnesHutTree m_barnesHutTree;
+        ConstraintSolver m_constraintSolver;
+        BlendMode m_blendMode = BlendMode::Alpha;
 
         glm::vec4 m_frustumPlanes[6];
 
-        glm::mat4 m_modelMatrix = glm::translate(glm::mat4(1.0f),glm::vec3(0.0f,0.0f,-5.0f));
-};
\ No newline at end of file
+        glm::mat4 m_modelMatrix;
+};
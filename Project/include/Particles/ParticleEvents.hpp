@@ -0,0 +1,78 @@
+// ParticleEvents.hpp - Header file for the per-frame particle event buffers.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+/**
+ * What happened to a particle. Each type has its own buffer on the emitter.
+ */
+enum class ParticleEventType {
+    Death = 0,     // The particle's life ran out or it hit a kill-on-contact collider.
+    Collision = 1, // The particle hit a collider.
+    Count = 2
+};
+
+/**
+ * Where an event happened, in the emitter space of the emitter that recorded it.
+ */
+struct ParticleEvent {
+    glm::vec3 position;
+    glm::vec3 velocity;
+};
+
+/**
+ * A fixed-capacity list of one frame's events. Storage is allocated when the capacity is set and
+ * never during an update: events past the capacity are only counted, so a frame with tens of
+ * thousands of deaths costs one comparison per extra event.
+ */
+class ParticleEventBuffer {
+    public:
+        /**
+         * Allocates room for capacity events per frame. A capacity of 0 stops recording.
+         */
+        void SetCapacity(int capacity) {
+            m_events.resize(capacity);
+            m_events.shrink_to_fit();
+            Clear();
+        }
+
+        int GetCapacity() const {
+            return (int)m_events.size();
+        }
+
+        void Clear() {
+            m_count = 0;
+            m_dropped = 0;
+        }
+
+        void Record(const glm::vec3& position, const glm::vec3& velocity) {
+            if (m_count < (int)m_events.size()) {
+                m_events[m_count].position = position;
+                m_events[m_count].velocity = velocity;
+                m_count++;
+            } else {
+                m_dropped++;
+            }
+        }
+
+        const ParticleEvent* GetEvents() const {
+            return m_events.data();
+        }
+
+        int GetCount() const {
+            return m_count;
+        }
+
+        /**
+         * The number of events that did not fit this frame.
+         */
+        int GetDroppedCount() const {
+            return m_dropped;
+        }
+
+    private:
+        std::vector<ParticleEvent> m_events;
+        int m_count = 0;
+        int m_dropped = 0;
+};
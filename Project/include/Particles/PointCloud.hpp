@@ -0,0 +1,82 @@
+// PointCloud.hpp - Header file for memory-mapped point clouds used as particle spawn positions.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cstddef>
+#include <string>
+
+#include "../MappedFile.hpp"
+
+/**
+ * A point cloud read in place from a memory-mapped file. Nothing is parsed up front beyond the
+ * header: each point is decoded from the mapping when an emitter spawns it, so even a scan with
+ * millions of points opens instantly and costs no heap memory.
+ * 
+ * Two layouts are accepted:
+ * 
+ * Binary little endian PLY whose vertex element has x, y and z properties of any scalar type, and
+ * optionally red, green, blue and alpha. Fixed-size elements may come before the vertices.
+ * 
+ * The flat layout below (little endian):
+ *     char[4]  "PCL1"
+ *     uint32   flags, bit 0 set when colors are present
+ *     uint64   number of points
+ *     float[3][] positions
+ *     uint8[4][] rgba colors, if present
+ */
+class PointCloud {
+    public:
+        /**
+         * Maps a point cloud in either layout.
+         * 
+         * @param fileName - path to the file.
+         * @param transform - transform from the file's space into emitter space.
+         * @return - whether the file was loaded.
+         */
+        bool Load(const std::string& fileName, const glm::mat4& transform = glm::mat4(1.0f));
+
+        size_t GetNumPoints() const {
+            return m_numPoints;
+        }
+
+        bool HasColors() const {
+            return m_hasColors;
+        }
+
+        /**
+         * Decodes a point's position, in emitter space.
+         */
+        glm::vec3 GetPosition(size_t index) const;
+
+        /**
+         * Decodes a point's color as rgba bytes. Points without alpha are opaque.
+         */
+        void GetColor(size_t index, unsigned char rgba[4]) const;
+
+    private:
+        enum class PropertyType {
+            Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64
+        };
+
+        // Where one property of point 0 is, and how far apart consecutive points' values are.
+        struct Property {
+            const unsigned char* base = nullptr;
+            size_t stride = 0;
+            PropertyType type = PropertyType::Float32;
+        };
+
+        bool LoadPLY(const std::string& fileName);
+
+        bool LoadFlat(const std::string& fileName);
+
+        static float ReadProperty(const Property& property, size_t index);
+
+        static unsigned char ReadColor(const Property& property, size_t index);
+
+        MappedFile m_file;
+        glm::mat4 m_transform = glm::mat4(1.0f);
+        size_t m_numPoints = 0;
+        bool m_hasColors = false;
+        Property m_x, m_y, m_z;
+        Property m_red, m_green, m_blue, m_alpha;
+};
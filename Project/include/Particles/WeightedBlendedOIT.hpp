@@ -0,0 +1,49 @@
+// WeightedBlendedOIT.hpp - Header file for the weighted blended order-independent transparency render target.
+#pragma once
+
+#include <glad/glad.h>
+
+#include "../Startup/Shader.hpp"
+
+/**
+ * Accumulation and revealage targets for weighted blended order-independent transparency
+ * (McGuire and Bavoil 2013). Transparent geometry is accumulated in any order between Begin()
+ * and End(), and End() composites the weighted average over the default framebuffer.
+ */
+class WeightedBlendedOIT {
+    public:
+        WeightedBlendedOIT(int width, int height);
+        ~WeightedBlendedOIT();
+
+        /**
+         * Binds and clears the OIT targets and sets the accumulation blend state.
+         */
+        void Begin();
+
+        /**
+         * Rebinds the default framebuffer and composites the accumulated transparency over it.
+         */
+        void End();
+
+        /**
+         * Recreates the targets if the window size changed.
+         */
+        void Resize(int width, int height);
+
+    private:
+        void CreateTargets();
+
+        void DeleteTargets();
+
+        int m_width;
+        int m_height;
+
+        GLuint m_framebuffer = 0;
+        GLuint m_accumTexture = 0;
+        GLuint m_revealageTexture = 0;
+        GLuint m_depthRenderbuffer = 0;
+
+        Shader* m_compositeShader;
+        GLuint m_compositeProgram;
+        GLuint m_fullscreenVAO = 0;
+};
@@ -0,0 +1,79 @@
+// BarnesHutTree.hpp - Header file for the Barnes-Hut octree used for n-body gravity.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+#include "../Particles/Particle.hpp"
+
+struct NBodySettings {
+    float theta = 0.7f;                  // Opening angle; smaller is more accurate and slower.
+    float gravitationalConstant = 0.02f;
+    float particleMass = 1.0f;
+    float softening = 0.05f;             // Plummer softening length, avoids singular close encounters.
+    int leafSize = 8;                    // Particles per leaf before a node is split.
+};
+
+/**
+ * An octree rebuilt from the particle positions every step. The top levels are split serially,
+ * then the subtrees below them are built in parallel and joined into one node array. Forces are
+ * evaluated in parallel, and a node is treated as a single mass when size / distance < theta,
+ * so each step costs O(n log n).
+ */
+class BarnesHutTree {
+    public:
+        /**
+         * Rebuilds the tree and adds the gravitational acceleration of every particle on every other
+         * to the particle velocities.
+         * 
+         * @param particles - the live particles.
+         * @param count - the number of live particles.
+         * @param deltaTime - seconds elapsed since the last update.
+         */
+        void ApplyGravity(Particle* particles, int count, float deltaTime);
+
+        NBodySettings& GetSettings() {
+            return m_settings;
+        }
+
+    private:
+        struct Node {
+            glm::vec3 centerOfMass;
+            float mass;
+            glm::vec3 center;     // Center of the node's cube.
+            float halfSize;
+            int firstChild;       // Children are contiguous; -1 for leaves.
+            int childCount;
+            int firstParticle;    // Leaf particle range in m_order.
+            int particleCount;
+        };
+
+        // A subtree whose construction is deferred to a parallel task.
+        struct BuildTask {
+            int nodeIndex;
+            int begin, end;
+            glm::vec3 center;
+            float halfSize;
+            std::vector<Node> nodes;
+        };
+
+        void Build(const Particle* particles, int count);
+
+        void BuildTop(int nodeIndex, int begin, int end, const glm::vec3& center, float halfSize, int depth);
+
+        void BuildNode(std::vector<Node>& nodes, int nodeIndex, int begin, int end,
+                       const glm::vec3& center, float halfSize, int depth);
+
+        void PartitionOctants(int begin, int end, const glm::vec3& center, int octantEnds[8]);
+
+        glm::vec3 ComputeAcceleration(const glm::vec3& position, int self) const;
+
+        NBodySettings m_settings;
+        std::vector<Node> m_nodes;
+        std::vector<BuildTask> m_tasks;
+        std::vector<int> m_topNodes;
+        std::vector<bool> m_topNodeIsTask;
+
+        std::vector<int> m_order;              // Particle indices in tree order.
+        std::vector<glm::vec3> m_positions;    // Particle positions by particle index.
+};
@@ -0,0 +1,55 @@
+// BoidsSolver.hpp - Header file for the boids flocking behavior.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+#include "../Particles/Particle.hpp"
+#include "SpatialGrid.hpp"
+
+struct BoidsSettings {
+    float neighborRadius = 1.0f;     // Radius for alignment and cohesion; also the grid cell size.
+    float separationRadius = 0.35f;  // Neighbors closer than this push each other apart.
+    int maxNeighbors = 12;           // Each boid considers at most this many flockmates.
+    float fieldOfViewCos = -0.5f;    // Cosine of the half view angle; -0.5 is 240 degrees of vision.
+
+    float separationWeight = 6.0f;
+    float alignmentWeight = 2.0f;
+    float cohesionWeight = 1.0f;
+
+    float minSpeed = 2.0f;
+    float maxSpeed = 6.0f;
+
+    // Boids past this distance from the emitter steer back toward it.
+    float boundsRadius = 10.0f;
+    float boundsWeight = 4.0f;
+};
+
+/**
+ * Reynolds flocking: separation, alignment and cohesion. Each boid looks at a bounded number
+ * of flockmates inside its field of view, found through the spatial grid. Steering is
+ * computed in parallel in grid order and written back to the particle velocities.
+ */
+class BoidsSolver {
+    public:
+        /**
+         * Adds this frame's flocking steering to the particle velocities and clamps their speed.
+         * 
+         * @param particles - the live particles.
+         * @param count - the number of live particles.
+         * @param grid - the grid to rebuild with the neighbor radius.
+         * @param deltaTime - seconds elapsed since the last update.
+         */
+        void Steer(Particle* particles, int count, SpatialGrid& grid, float deltaTime);
+
+        BoidsSettings& GetSettings() {
+            return m_settings;
+        }
+
+    private:
+        BoidsSettings m_settings;
+
+        // Velocities in grid order before and after steering.
+        std::vector<glm::vec3> m_velocities;
+        std::vector<glm::vec3> m_steeredVelocities;
+};
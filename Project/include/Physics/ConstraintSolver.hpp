@@ -0,0 +1,85 @@
+// ConstraintSolver.hpp - Header file for the position-based dynamics distance constraint solver.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+#include "../Particles/Particle.hpp"
+
+struct DistanceConstraint {
+    int a, b;          // Particle indices.
+    float restLength;
+};
+
+struct ConstraintSettings {
+    int iterations = 8;        // Jacobi iterations per step.
+    float relaxation = 1.5f;   // Over-relaxation of the averaged Jacobi corrections.
+};
+
+/**
+ * Position-based dynamics (Mueller et al. 2007) for distance constraints between particles,
+ * used to build ropes, chains and streamers. The solver uses Jacobi iterations: each
+ * constraint computes its corrections on its own, then each particle averages the corrections
+ * of its constraints. Both passes are parallel with no atomics, using per-particle constraint
+ * lists that are precomputed whenever the constraints change.
+ */
+class ConstraintSolver {
+    public:
+        /**
+         * Registers the next constrained particle. Constrained particles are the first
+         * GetNumParticles() particles of the span passed to the solver.
+         * 
+         * @param inverseMass - 0 pins the particle in place.
+         */
+        void AddParticle(float inverseMass) {
+            m_inverseMasses.push_back(inverseMass);
+        }
+
+        void AddConstraint(int a, int b, float restLength) {
+            m_constraints.push_back({ a, b, restLength });
+            m_adjacencyDirty = true;
+        }
+
+        int GetNumParticles() {
+            return (int)m_inverseMasses.size();
+        }
+
+        void SetInverseMass(int index, float inverseMass) {
+            m_inverseMasses[index] = inverseMass;
+        }
+
+        /**
+         * Records positions before integration; PBD derives velocities from the change.
+         */
+        void SavePositions(const Particle* particles);
+
+        /**
+         * Projects the integrated positions onto the constraints and updates velocities to match.
+         * 
+         * @param particles - the span starting with the constrained particles.
+         * @param deltaTime - seconds elapsed since the last update.
+         */
+        void Solve(Particle* particles, float deltaTime);
+
+        ConstraintSettings& GetSettings() {
+            return m_settings;
+        }
+
+    private:
+        void BuildAdjacency();
+
+        ConstraintSettings m_settings;
+        std::vector<DistanceConstraint> m_constraints;
+        std::vector<float> m_inverseMasses;
+        std::vector<glm::vec3> m_previousPositions;
+
+        // Per-particle constraint lists in CSR form. Entries are constraint indices, negated
+        // (minus one) when the particle is the constraint's second endpoint.
+        std::vector<int> m_adjacencyStart;
+        std::vector<int> m_adjacency;
+        bool m_adjacencyDirty = true;
+
+        // Correction for each constraint's first endpoint; the second endpoint gets the opposite,
+        // scaled by its share of the inverse mass.
+        std::vector<glm::vec3> m_corrections;
+};
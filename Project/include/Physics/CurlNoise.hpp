@@ -0,0 +1,23 @@
+// CurlNoise.hpp - Header file for precomputed, tileable curl-noise volumes.
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "FieldVolume.hpp"
+
+/**
+ * Fills a volume with curl noise: the curl of a vector potential made of three channels of periodic
+ * gradient noise. The result is divergence free, so particles swirl without bunching up, and it
+ * tiles seamlessly, so the volume can be repeated over any extent. Slices are generated in parallel.
+ * The field is scaled to an RMS magnitude of 1, so an affector's strength is its typical acceleration.
+ * 
+ * @param volume - the volume to fill; it is allocated with wrapped addressing.
+ * @param resolution - the number of samples along each axis.
+ * @param cellSize - the emitter-space distance between samples; the volume repeats every resolution * cellSize.
+ * @param period - the number of noise lattice cells across the volume for the lowest octave.
+ * @param octaves - the number of octaves, each with twice the frequency and half the amplitude. The
+ *                  finest octave should keep at least four samples per lattice cell.
+ * @param seed - selects the lattice gradients.
+ */
+void GenerateCurlNoise(FieldVolume<glm::vec3>& volume, int resolution, float cellSize,
+                       int period = 4, int octaves = 2, unsigned int seed = 1);
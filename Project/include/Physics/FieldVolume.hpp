@@ -0,0 +1,143 @@
+// FieldVolume.hpp - Header file for regular 3D grids of samples with trilinear filtering.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <cmath>
+#include <vector>
+
+/**
+ * A regular 3D grid of values (distances, velocities, ...) placed in emitter space. Sample i, j, k
+ * sits at origin + (i, j, k) * cellSize and x varies fastest in memory. Lookups between samples are
+ * trilinear. A volume can either own its samples or view samples that live elsewhere, such as a
+ * memory-mapped file.
+ */
+template <typename T>
+class FieldVolume {
+    public:
+        FieldVolume() = default;
+        // Owned samples move with the volume; a copy would still point at the original's samples.
+        FieldVolume(const FieldVolume&) = delete;
+        FieldVolume& operator=(const FieldVolume&) = delete;
+        FieldVolume(FieldVolume&&) = default;
+        FieldVolume& operator=(FieldVolume&&) = default;
+
+        /**
+         * Allocates zeroed samples owned by the volume.
+         * 
+         * @param dimensions - the number of samples along each axis.
+         * @param origin - the emitter-space position of sample (0, 0, 0).
+         * @param cellSize - the distance between neighboring samples.
+         * @param wrap - whether lookups repeat the volume (for tileable fields) instead of clamping to its edges.
+         */
+        void Allocate(const glm::ivec3& dimensions, const glm::vec3& origin, float cellSize, bool wrap = false) {
+            m_storage.assign((size_t)dimensions.x * dimensions.y * dimensions.z, T());
+            SetLayout(m_storage.data(), dimensions, origin, cellSize, wrap);
+        }
+
+        /**
+         * Views samples owned by the caller, which must outlive the volume.
+         */
+        void SetExternalData(const T* data, const glm::ivec3& dimensions, const glm::vec3& origin, float cellSize, bool wrap = false) {
+            m_storage.clear();
+            SetLayout(const_cast<T*>(data), dimensions, origin, cellSize, wrap);
+        }
+
+        bool IsEmpty() const {
+            return m_data == nullptr;
+        }
+
+        /**
+         * Returns whether a position lies inside the sampled region.
+         */
+        bool Contains(const glm::vec3& position) const {
+            glm::vec3 grid = (position - m_origin) * m_inverseCellSize;
+            return grid.x >= 0.0f && grid.y >= 0.0f && grid.z >= 0.0f &&
+                   grid.x <= m_dimensions.x - 1 && grid.y <= m_dimensions.y - 1 && grid.z <= m_dimensions.z - 1;
+        }
+
+        /**
+         * Trilinearly interpolates the samples around a position.
+         */
+        T Sample(const glm::vec3& position) const {
+            glm::vec3 grid = (position - m_origin) * m_inverseCellSize;
+            glm::vec3 cell = glm::vec3(std::floor(grid.x), std::floor(grid.y), std::floor(grid.z));
+            glm::vec3 f = grid - cell;
+            glm::ivec3 i0 = glm::ivec3((int)cell.x, (int)cell.y, (int)cell.z);
+            glm::ivec3 i1 = i0 + glm::ivec3(1);
+            i0 = Address(i0);
+            i1 = Address(i1);
+
+            T c00 = At(i0.x, i0.y, i0.z) * (1.0f - f.x) + At(i1.x, i0.y, i0.z) * f.x;
+            T c10 = At(i0.x, i1.y, i0.z) * (1.0f - f.x) + At(i1.x, i1.y, i0.z) * f.x;
+            T c01 = At(i0.x, i0.y, i1.z) * (1.0f - f.x) + At(i1.x, i0.y, i1.z) * f.x;
+            T c11 = At(i0.x, i1.y, i1.z) * (1.0f - f.x) + At(i1.x, i1.y, i1.z) * f.x;
+            T c0 = c00 * (1.0f - f.y) + c10 * f.y;
+            T c1 = c01 * (1.0f - f.y) + c11 * f.y;
+            return c0 * (1.0f - f.z) + c1 * f.z;
+        }
+
+        T& At(int x, int y, int z) {
+            return m_data[((size_t)z * m_dimensions.y + y) * m_dimensions.x + x];
+        }
+
+        const T& At(int x, int y, int z) const {
+            return m_data[((size_t)z * m_dimensions.y + y) * m_dimensions.x + x];
+        }
+
+        /**
+         * Returns the emitter-space position of a sample.
+         */
+        glm::vec3 GetSamplePosition(int x, int y, int z) const {
+            return m_origin + glm::vec3(x, y, z) * m_cellSize;
+        }
+
+        const glm::ivec3& GetDimensions() const {
+            return m_dimensions;
+        }
+
+        const glm::vec3& GetOrigin() const {
+            return m_origin;
+        }
+
+        float GetCellSize() const {
+            return m_cellSize;
+        }
+
+        T* GetData() {
+            return m_data;
+        }
+
+    private:
+        void SetLayout(T* data, const glm::ivec3& dimensions, const glm::vec3& origin, float cellSize, bool wrap) {
+            m_data = data;
+            m_dimensions = dimensions;
+            m_origin = origin;
+            m_cellSize = cellSize;
+            m_inverseCellSize = 1.0f / cellSize;
+            m_wrap = wrap;
+        }
+
+        /**
+         * Maps a sample coordinate into the volume by wrapping or clamping.
+         */
+        glm::ivec3 Address(const glm::ivec3& index) const {
+            glm::ivec3 result;
+            for (int axis = 0; axis < 3; axis++) {
+                int n = m_dimensions[axis];
+                if (m_wrap) {
+                    result[axis] = ((index[axis] % n) + n) % n;
+                } else {
+                    result[axis] = index[axis] < 0 ? 0 : (index[axis] >= n ? n - 1 : index[axis]);
+                }
+            }
+            return result;
+        }
+
+        std::vector<T> m_storage;
+        T* m_data = nullptr;
+        glm::ivec3 m_dimensions = glm::ivec3(0);
+        glm::vec3 m_origin = glm::vec3(0.0f);
+        float m_cellSize = 1.0f;
+        float m_inverseCellSize = 1.0f;
+        bool m_wrap = false;
+};
@@ -0,0 +1,110 @@
+// MeshCollider.hpp - Header file for static triangle mesh collision through a BVH.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <string>
+#include <vector>
+
+#include "../Particles/Particle.hpp"
+
+// Triangles tested together by one leaf test.
+static const int TRIANGLE_PACKET_WIDTH = 4;
+
+struct MeshColliderSettings {
+    float restitution = 0.3f;
+    float friction = 0.3f;
+    bool killOnContact = false;
+    float skinWidth = 1e-3f; // Distance particles are left above the surface after a hit.
+};
+
+/**
+ * Reads the vertices and faces of an OBJ file. Polygons are triangulated as fans; texture
+ * coordinates, normals and materials are ignored.
+ * 
+ * @param fileName - path to the OBJ file.
+ * @param transform - transform applied to every vertex.
+ * @param vertices - receives the transformed vertices.
+ * @param indices - receives three vertex indices per triangle.
+ * @return - whether the file was read and every face index is in range.
+ */
+bool LoadOBJTriangles(const std::string& fileName, const glm::mat4& transform,
+                      std::vector<glm::vec3>& vertices, std::vector<int>& indices);
+
+/**
+ * A static triangle mesh loaded from an OBJ file. Triangles are grouped into packets of four stored
+ * as structure of arrays, and a bounding volume hierarchy is built over the packets once at load time.
+ * Each update, every particle's motion segment for the step is traced through the hierarchy, so
+ * particles cannot tunnel through thin geometry however fast they move.
+ */
+class MeshCollider {
+    public:
+        /**
+         * Loads the vertices and faces of an OBJ file and builds the hierarchy. Polygons are
+         * triangulated as fans; texture coordinates, normals and materials are ignored.
+         * 
+         * @param fileName - path to the OBJ file.
+         * @param transform - transform from the file's space into emitter space.
+         * @return - whether the file was loaded.
+         */
+        bool LoadOBJ(const std::string& fileName, const glm::mat4& transform = glm::mat4(1.0f));
+
+        /**
+         * Replaces the mesh with the given triangles and rebuilds the hierarchy.
+         * 
+         * @param vertices - triangle vertices in emitter space.
+         * @param indices - three vertex indices per triangle.
+         */
+        void SetTriangles(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices);
+
+        /**
+         * Collides particles with the mesh. A particle's segment runs from where it was before this
+         * step's integration to where it is now.
+         * 
+         * @param particles - the first particle of the span.
+         * @param previousPositions - each particle's position before this step's integration.
+         * @param count - the number of particles in the span.
+         * @return - the number of particles killed on contact (their life is set to zero).
+         */
+        int Collide(Particle* particles, const glm::vec3* previousPositions, int count) const;
+
+        int GetNumTriangles() const {
+            return m_numTriangles;
+        }
+
+        MeshColliderSettings& GetSettings() {
+            return m_settings;
+        }
+
+        const MeshColliderSettings& GetSettings() const {
+            return m_settings;
+        }
+
+    private:
+        // Four triangles as a vertex and two edges each. Unused lanes have zero edges and never hit.
+        struct TrianglePacket {
+            float v0x[TRIANGLE_PACKET_WIDTH], v0y[TRIANGLE_PACKET_WIDTH], v0z[TRIANGLE_PACKET_WIDTH];
+            float e1x[TRIANGLE_PACKET_WIDTH], e1y[TRIANGLE_PACKET_WIDTH], e1z[TRIANGLE_PACKET_WIDTH];
+            float e2x[TRIANGLE_PACKET_WIDTH], e2y[TRIANGLE_PACKET_WIDTH], e2z[TRIANGLE_PACKET_WIDTH];
+        };
+
+        struct BVHNode {
+            glm::vec3 boundsMin;
+            int leftChild;   // The right child follows the left one; unused for leaves.
+            glm::vec3 boundsMax;
+            int packet;      // Packet index for leaves, -1 for interior nodes.
+        };
+
+        struct BuildTriangle {
+            glm::vec3 a, b, c;
+            glm::vec3 centroid;
+        };
+
+        void BuildNode(int nodeIndex, std::vector<BuildTriangle>& triangles, int begin, int end);
+
+        bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float& hitT, glm::vec3& hitNormal) const;
+
+        MeshColliderSettings m_settings;
+        std::vector<BVHNode> m_nodes;
+        std::vector<TrianglePacket> m_packets;
+        int m_numTriangles = 0;
+};
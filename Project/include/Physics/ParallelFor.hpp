@@ -0,0 +1,66 @@
+// ParallelFor.hpp - Header file for the worker thread pool used by the particle simulation.
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed pool of worker threads that split index ranges between them. The calling thread
+ * takes part in the work, and calls made from inside a worker run serially, so simulation
+ * code can nest parallel loops without deadlocking.
+ */
+class ThreadPool {
+    public:
+        /**
+         * Returns the process-wide pool, sized to the hardware concurrency.
+         */
+        static ThreadPool& Get();
+
+        ~ThreadPool();
+
+        int GetNumThreads() {
+            return (int)m_workers.size() + 1;
+        }
+
+        /**
+         * Runs task(begin, end) over [0, count) in chunks of at least grainSize and waits for all of them.
+         * 
+         * @param count - the number of items.
+         * @param grainSize - the smallest chunk worth handing to another thread.
+         * @param task - called with half-open index ranges.
+         */
+        void ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task);
+
+    private:
+        explicit ThreadPool(int numWorkers);
+
+        void WorkerLoop();
+
+        void RunChunks();
+
+        std::vector<std::thread> m_workers;
+        std::mutex m_mutex;
+        std::condition_variable m_wakeWorkers;
+        std::condition_variable m_jobFinished;
+        bool m_shutdown = false;
+
+        // The job currently being executed.
+        const std::function<void(int, int)>* m_task = nullptr;
+        int m_count = 0;
+        int m_chunkSize = 0;
+        std::atomic<int> m_nextIndex{0};
+        int m_pendingWorkers = 0;
+        unsigned m_jobGeneration = 0;
+        std::mutex m_submitMutex;
+};
+
+/**
+ * Convenience wrapper for ThreadPool::Get().ParallelFor(...).
+ */
+inline void ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task) {
+    ThreadPool::Get().ParallelFor(count, grainSize, task);
+}
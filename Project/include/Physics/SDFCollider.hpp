@@ -0,0 +1,75 @@
+// SDFCollider.hpp - Header file for collision against baked signed distance fields.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <string>
+
+#include "../Particles/Particle.hpp"
+#include "FieldVolume.hpp"
+
+struct SDFColliderSettings {
+    float restitution = 0.3f;
+    float friction = 0.3f;
+    bool killOnContact = false;
+    float thickness = 0.0f; // Particles are kept this far outside the zero isosurface.
+};
+
+/**
+ * A solid described by a grid of signed distances (negative inside), loaded from a binary file.
+ * Each particle costs one trilinear lookup, plus a gradient for the few that touch the surface,
+ * however detailed the baked geometry was.
+ * 
+ * File layout (little endian):
+ *     char[4]  "SDF1"
+ *     int32[3] number of samples along x, y and z
+ *     float[3] emitter-space position of the first sample
+ *     float    distance between samples
+ *     float[]  distances, x fastest, then y, then z
+ */
+class SDFCollider {
+    public:
+        /**
+         * Loads a distance field from a file in the layout above.
+         * 
+         * @param fileName - path to the file.
+         * @return - whether the file was loaded.
+         */
+        bool Load(const std::string& fileName);
+
+        /**
+         * Returns the interpolated signed distance at a position.
+         */
+        float GetDistance(const glm::vec3& position) const {
+            return m_distances.Sample(position);
+        }
+
+        /**
+         * Returns the outward surface normal at a position from the central-difference gradient.
+         */
+        glm::vec3 GetNormal(const glm::vec3& position) const;
+
+        /**
+         * Pushes particles inside the solid back to its surface and bounces them.
+         * 
+         * @param particles - the first particle of the span.
+         * @param count - the number of particles in the span.
+         * @return - the number of particles killed on contact (their life is set to zero).
+         */
+        int Collide(Particle* particles, int count) const;
+
+        FieldVolume<float>& GetDistances() {
+            return m_distances;
+        }
+
+        SDFColliderSettings& GetSettings() {
+            return m_settings;
+        }
+
+        const SDFColliderSettings& GetSettings() const {
+            return m_settings;
+        }
+
+    private:
+        SDFColliderSettings m_settings;
+        FieldVolume<float> m_distances;
+};
@@ -0,0 +1,55 @@
+// SPHSolver.hpp - Header file for the smoothed-particle hydrodynamics fluid solver.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <vector>
+
+#include "../Particles/Particle.hpp"
+#include "SpatialGrid.hpp"
+
+struct SPHSettings {
+    float smoothingRadius = 0.4f;  // Kernel support h; also the neighbor grid cell size.
+    float restDensity = 1000.0f;   // Target density of the fluid.
+    float stiffness = 20.0f;       // Pressure per unit of density above rest.
+    float viscosity = 3.0f;        // Dynamic viscosity coefficient.
+    float particleMass = 8.0f;     // Rest density times (h / 2)^3, so rest spacing is about h / 2.
+    int substeps = 4;              // Solver steps per frame; explicit SPH needs small steps.
+
+    // Container box in emitter space. Particles are reflected off its walls.
+    glm::vec3 boundsMin = glm::vec3(-3.0f, -4.0f, -3.0f);
+    glm::vec3 boundsMax = glm::vec3(3.0f, 12.0f, 3.0f);
+    float boundaryRestitution = 0.3f;
+};
+
+/**
+ * Weakly compressible SPH (Mueller et al. 2003): density with the poly6 kernel, pressure
+ * with the spiky gradient, and viscosity with the viscosity Laplacian. Every pass runs over
+ * the particles in spatial grid order, with positions, velocities and densities stored in
+ * that order, so the neighbor loops read memory that is close together. Passes are parallel.
+ */
+class SPHSolver {
+    public:
+        /**
+         * Advances the fluid by deltaTime: pressure and viscosity forces, integration, and container walls.
+         * External forces must already be applied to the particle velocities.
+         * 
+         * @param particles - the live particles.
+         * @param count - the number of live particles.
+         * @param grid - the grid to rebuild with the smoothing radius each substep.
+         * @param deltaTime - seconds to advance.
+         */
+        void Step(Particle* particles, int count, SpatialGrid& grid, float deltaTime);
+
+        SPHSettings& GetSettings() {
+            return m_settings;
+        }
+
+    private:
+        SPHSettings m_settings;
+
+        // Per-particle data in grid order.
+        std::vector<glm::vec3> m_velocities;
+        std::vector<float> m_densities;
+        std::vector<float> m_pressures;
+        std::vector<glm::vec3> m_accelerations;
+};
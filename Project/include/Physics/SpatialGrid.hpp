@@ -0,0 +1,157 @@
+// SpatialGrid.hpp - Header file for the uniform-grid spatial hash used for particle neighbor queries.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "../Particles/Particle.hpp"
+
+/**
+ * A uniform grid hashed into a table of buckets and filled with a counting sort, so a full
+ * rebuild is linear in the particle count. Particle positions are copied in bucket order,
+ * which keeps the particles of one cell next to each other in memory during neighbor loops.
+ */
+class SpatialGrid {
+    public:
+        /**
+         * Rebuilds the grid from the first count particles, in parallel.
+         * 
+         * @param particles - the particles to insert.
+         * @param count - the number of particles.
+         * @param cellSize - the edge length of a grid cell; queries are cheapest when it equals the query radius.
+         */
+        void Build(const Particle* particles, int count, float cellSize);
+
+        /**
+         * Calls fn(particleIndex, position, distanceSquared) for every particle within radius of position,
+         * including a particle at position itself.
+         */
+        template <typename Function>
+        void ForEachNeighbor(const glm::vec3& position, float radius, Function&& fn) const;
+
+        /**
+         * Like ForEachNeighbor, but calls fn(sortedSlot, distanceSquared) with the neighbor's slot in the
+         * sorted arrays. Solvers that keep their per-particle data in sorted order read it contiguously.
+         * If fn returns bool, returning false ends the query early.
+         */
+        template <typename Function>
+        void ForEachNeighborSlot(const glm::vec3& position, float radius, Function&& fn) const;
+
+        /**
+         * Returns the integer grid cell containing a position.
+         */
+        glm::ivec3 GetCell(const glm::vec3& position) const {
+            return glm::ivec3((int)std::floor(position.x * m_inverseCellSize),
+                              (int)std::floor(position.y * m_inverseCellSize),
+                              (int)std::floor(position.z * m_inverseCellSize));
+        }
+
+        /**
+         * Hashes a grid cell to a bucket of the table.
+         */
+        uint32_t HashCell(const glm::ivec3& cell) const {
+            uint32_t hash = (uint32_t)cell.x * 73856093u ^ (uint32_t)cell.y * 19349663u ^ (uint32_t)cell.z * 83492791u;
+            return hash & m_tableMask;
+        }
+
+        int GetNumParticles() const {
+            return m_numParticles;
+        }
+
+        float GetCellSize() const {
+            return m_cellSize;
+        }
+
+        // Particles in bucket order: bucket b holds sorted entries [m_bucketStart[b], m_bucketStart[b + 1]).
+        const std::vector<int>& GetSortedIndices() const {
+            return m_sortedIndices;
+        }
+
+        const std::vector<glm::vec3>& GetSortedPositions() const {
+            return m_sortedPositions;
+        }
+
+    private:
+        int m_numParticles = 0;
+        float m_cellSize = 1.0f;
+        float m_inverseCellSize = 1.0f;
+        uint32_t m_tableMask = 0;
+
+        std::vector<uint32_t> m_bucketStart;
+        std::vector<uint32_t> m_particleBucket;
+        std::vector<uint32_t> m_particleRank;
+        std::unique_ptr<std::atomic<uint32_t>[]> m_bucketCounts;
+        uint32_t m_bucketCountsSize = 0;
+
+        std::vector<int> m_sortedIndices;
+        std::vector<glm::vec3> m_sortedPositions;
+};
+
+template <typename Function>
+void SpatialGrid::ForEachNeighbor(const glm::vec3& position, float radius, Function&& fn) const {
+    ForEachNeighborSlot(position, radius, [&](uint32_t slot, float distanceSquared) {
+        fn(m_sortedIndices[slot], m_sortedPositions[slot], distanceSquared);
+    });
+}
+
+template <typename Function>
+void SpatialGrid::ForEachNeighborSlot(const glm::vec3& position, float radius, Function&& fn) const {
+    if (m_numParticles == 0) {
+        return;
+    }
+
+    float radiusSquared = radius * radius;
+    int reach = (int)std::ceil(radius * m_inverseCellSize);
+    glm::ivec3 center = GetCell(position);
+
+    // Several cells can hash to the same bucket; visit each bucket once so no particle is reported twice.
+    // The common radius <= cell size case stays on the stack.
+    int numCells = (2 * reach + 1) * (2 * reach + 1) * (2 * reach + 1);
+    uint32_t localVisited[27];
+    std::vector<uint32_t> heapVisited;
+    uint32_t* visited = localVisited;
+    if (numCells > 27) {
+        heapVisited.resize(numCells);
+        visited = heapVisited.data();
+    }
+    int numVisited = 0;
+
+    for (int z = -reach; z <= reach; z++) {
+        for (int y = -reach; y <= reach; y++) {
+            for (int x = -reach; x <= reach; x++) {
+                uint32_t bucket = HashCell(center + glm::ivec3(x, y, z));
+
+                bool seen = false;
+                for (int i = 0; i < numVisited; i++) {
+                    if (visited[i] == bucket) {
+                        seen = true;
+                        break;
+                    }
+                }
+                if (seen) {
+                    continue;
+                }
+                visited[numVisited++] = bucket;
+
+                for (uint32_t j = m_bucketStart[bucket]; j < m_bucketStart[bucket + 1]; j++) {
+                    glm::vec3 offset = m_sortedPositions[j] - position;
+                    float distanceSquared = glm::dot(offset, offset);
+                    if (distanceSquared <= radiusSquared) {
+                        if constexpr (std::is_same<decltype(fn(j, distanceSquared)), bool>::value) {
+                            if (!fn(j, distanceSquared)) {
+                                return;
+                            }
+                        } else {
+                            fn(j, distanceSquared);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,38 @@
+// VectorField.hpp - Header file for velocity and force fields loaded from disk.
+#pragma once
+
+#include "glm/glm.hpp"
+#include <string>
+
+#include "../MappedFile.hpp"
+#include "FieldVolume.hpp"
+
+/**
+ * A grid of vectors authored offline (wind, flow or force fields). The file is memory-mapped and
+ * the volume samples straight out of the mapping, so loading is instant and no copy is made.
+ * 
+ * File layout (little endian):
+ *     char[4]  "VEC1"
+ *     int32[3] number of samples along x, y and z
+ *     float[3] emitter-space position of the first sample
+ *     float    distance between samples
+ *     float[3][] vectors, x fastest, then y, then z
+ */
+class VectorField {
+    public:
+        /**
+         * Maps a field file in the layout above.
+         * 
+         * @param fileName - path to the file.
+         * @return - whether the file was loaded.
+         */
+        bool Load(const std::string& fileName);
+
+        const FieldVolume<glm::vec3>& GetVolume() const {
+            return m_volume;
+        }
+
+    private:
+        MappedFile m_file;
+        FieldVolume<glm::vec3> m_volume;
+};
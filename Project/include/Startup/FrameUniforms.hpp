@@ -0,0 +1,19 @@
+// FrameUniforms.hpp - Per-frame camera data shared by every shader program through a uniform buffer.
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// Binding point of the uniform block, matching "layout (std140, binding = 0) uniform FrameData" in the shaders.
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
+/**
+ * CPU mirror of the FrameData uniform block. Only mat4/vec4 members are used so the
+ * std140 layout matches the C++ layout without padding.
+ */
+struct FrameUniforms {
+    glm::mat4 viewMatrix;
+    glm::mat4 projectionMatrix;
+    glm::mat4 viewProjectionMatrix;
+    glm::vec4 cameraPosition;
+};
@@ -4,7 +4,8 @@
 #include <SDL2/SDL.h>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
-#include "../include/Particles/ParticleEmitter.hpp"
+#include "../include/Particles/EmitterManager.hpp"
+#include "../include/Physics/FieldVolume.hpp"
 
 class SDLGraphicsProgram {
     public:
@@ -46,10 +47,22 @@ class SDLGraphicsProgram {
          */ 
         void Loop();
 
+        /**
+         * Computes this frame's camera matrices and uploads them to the frame uniform buffer.
+         */
+        void UpdateFrameUniforms();
+
     private:
         SDL_Window* m_window = nullptr;
         SDL_GLContext m_openGLContext = nullptr;
-        ParticleEmitter *m_particleEmitter;
+        EmitterManager *m_emitterManager;
+        GLuint m_frameUniformBuffer = 0;
+        // Curl noise shared by every emitter's turbulence affector.
+        FieldVolume<glm::vec3> m_turbulence;
+        // Smoky cross wind around the fountain, owned by the emitter manager while enabled.
+        GridFluidSolver* m_gridFluid = nullptr;
+        // Sparks spawned where the fountain hits its floor, owned by the emitter manager while enabled.
+        ParticleEmitter* m_splashEmitter = nullptr;
 
         bool m_quit = false;
         bool m_frustumCullingStatus = false;
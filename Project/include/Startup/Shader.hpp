@@ -5,6 +5,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -42,6 +45,40 @@ class Shader {
          */
         GLuint CreateShaderProgram(const std::string &vertexShaderSource, const std::string &fragmentShaderSource);
 
+        /**
+         * Creates a compute program from a single compute shader.
+         * 
+         * @param computeShaderSource - the string representation of the shader file from LoadShaderAsString(...).
+         * @return - a GLuint representing the compute program.
+         */
+        GLuint CreateComputeProgram(const std::string &computeShaderSource);
+
+        /**
+         * Hashes the shader sources together with the driver's vendor, renderer, and version strings.
+         * Program binaries are only valid for the driver that produced them, so all of these form the key.
+         * 
+         * @param vertexShaderSource - the vertex shader source text.
+         * @param fragmentShaderSource - the fragment shader source text.
+         * @return - a 64-bit FNV-1a hash identifying the program binary.
+         */
+        uint64_t HashProgramSources(const std::string &vertexShaderSource, const std::string &fragmentShaderSource);
+
+        /**
+         * Tries to create a program from a cached binary on disk.
+         * 
+         * @param key - the hash from HashProgramSources(...).
+         * @return - a linked program object, or 0 if there is no usable cached binary.
+         */
+        GLuint LoadProgramBinary(uint64_t key);
+
+        /**
+         * Writes a linked program's binary to the cache directory.
+         * 
+         * @param key - the hash from HashProgramSources(...).
+         * @param programObject - a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+         */
+        void SaveProgramBinary(uint64_t key, GLuint programObject);
+
         /**
          * Gets the shaderID.
          * 
@@ -79,12 +116,23 @@ class Shader {
          */
         const char* GLTypeToString(GLenum type);
 
+        /**
+         * Looks up a uniform location, querying the driver only the first time a name is used.
+         * 
+         * @param name - the name of the uniform in the shader.
+         * @return - the uniform location, or -1 if the program has no such active uniform.
+         */
+        GLint GetUniformLocation(const GLchar* name);
+
         void SetUniformMatrix4fv(const GLchar* name, const GLfloat* value);
 
         void SetUniform3f(const GLchar* name, float r, float g, float b);
 
         void PrintActiveUniforms(GLuint program);
 
+        // Directory where linked program binaries are cached between runs.
+        static const char* s_programCacheDirectory;
+
     private:
         std::string m_vertexString;
         std::string m_fragmentString;
@@ -92,4 +140,6 @@ class Shader {
         GLuint m_vertexShader;
         GLuint m_fragmentShader;
         GLuint m_shaderID;
+
+        std::unordered_map<std::string, GLint> m_uniformLocations;
 };
\ No newline at end of file
@@ -0,0 +1,8 @@
+#version 460 core
+
+// A single triangle covering the screen, generated from gl_VertexID without any vertex buffer.
+void main()
+{
+    vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,26 @@
+#version 460 core
+
+layout (binding = 0) uniform sampler2D u_Accum;
+layout (binding = 1) uniform sampler2D u_Revealage;
+
+out vec4 color;
+
+void main()
+{
+    ivec2 coord = ivec2(gl_FragCoord.xy);
+
+    // Nothing transparent covered this pixel.
+    float revealage = texelFetch(u_Revealage, coord, 0).r;
+    if (revealage == 1.0) {
+        discard;
+    }
+
+    // Guard against overflow of the half-float accumulation.
+    vec4 accum = texelFetch(u_Accum, coord, 0);
+    if (isinf(max(max(abs(accum.r), abs(accum.g)), abs(accum.b)))) {
+        accum.rgb = vec3(accum.a);
+    }
+
+    vec3 averageColor = accum.rgb / max(accum.a, 1e-5);
+    color = vec4(averageColor, 1.0 - revealage);
+}
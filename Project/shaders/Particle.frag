@@ -1,10 +1,20 @@
-#version 450 core
+#version 460 core
 
 in vec4 fragColor;
 
 out vec4 color;
 
+// Matches the BlendMode enum on the CPU.
+const int BLEND_OPAQUE = 3;
+
+uniform int u_BlendMode;
+
 void main()
 {
     color = fragColor;
+
+    // Opaque particles never discard, which keeps early depth rejection effective.
+    if (u_BlendMode == BLEND_OPAQUE) {
+        color.a = 1.0;
+    }
 }
@@ -1,28 +1,89 @@
-#version 450 core
-
-layout (location = 0) in vec3 quadVertices;
-layout (location = 1) in vec4 aParticle;
-layout (location = 2) in vec4 aColor;
+#version 460 core
 
 out vec4 fragColor;
 
-uniform mat4 u_ViewMatrix;
-uniform mat4 u_ModelMatrix;
-uniform mat4 u_ProjectionMatrix;
+// Camera data shared by all programs, uploaded once per frame.
+layout (std140, binding = 0) uniform FrameData {
+    mat4 u_ViewMatrix;
+    mat4 u_ProjectionMatrix;
+    mat4 u_ViewProjectionMatrix;
+    vec4 u_CameraPosition;
+};
+
+// Per-emitter data computed on the CPU once per frame, indexed by the draw within the multi-draw call.
+struct EmitterDrawData {
+    mat4 modelViewProjection;
+    vec4 cameraRight;
+    vec4 cameraUp;
+    int lifetimeCurve;
+};
+
+layout (std430, binding = 0) readonly buffer EmitterData {
+    EmitterDrawData u_Emitters[];
+};
+
+// Index of the first draw of the current multi-draw call, since gl_DrawID restarts at zero.
+uniform int u_DrawOffset;
+
+// Particle data pulled per instance: position in xyz, size in w.
+layout (std430, binding = 1) readonly buffer ParticlePositions {
+    vec4 u_ParticlePositions[];
+};
+
+// Particle colors packed as 4 normalized bytes.
+layout (std430, binding = 2) readonly buffer ParticleColors {
+    uint u_ParticleColors[];
+};
+
+// Particle ages normalized to [0, 1], written only for emitters with lifetime curves.
+layout (std430, binding = 7) readonly buffer ParticleAges {
+    float u_ParticleAges[];
+};
+
+// Two rows per emitter with curves: the color multiplier, then the size multiplier.
+uniform sampler1DArray u_LifetimeCurves;
+
+// Matches the BlendMode enum on the CPU.
+const int BLEND_PREMULTIPLIED = 2;
+
+uniform int u_BlendMode;
 
 void main()
 {
-    vec3 particlePosition = aParticle.xyz;
-    float particleSize = aParticle.w;
+    EmitterDrawData emitter = u_Emitters[u_DrawOffset + gl_DrawID];
+
+    // Each emitter's particles start at its draw's base instance.
+    int particleIndex = gl_BaseInstance + gl_InstanceID;
+    vec4 particle = u_ParticlePositions[particleIndex];
+    vec3 particlePosition = particle.xyz;
+    float particleSize = particle.w;
+    vec4 particleColor = unpackUnorm4x8(u_ParticleColors[particleIndex]);
+
+    // Scale the spawn color and size by the emitter's curves at the particle's age. Sampling at
+    // texel centers makes ages 0 and 1 land exactly on the first and last baked values.
+    if (emitter.lifetimeCurve >= 0) {
+        float resolution = float(textureSize(u_LifetimeCurves, 0).x);
+        float coordinate = (clamp(u_ParticleAges[particleIndex], 0.0, 1.0) * (resolution - 1.0) + 0.5) / resolution;
+        vec4 colorScale = textureLod(u_LifetimeCurves, vec2(coordinate, float(2 * emitter.lifetimeCurve)), 0.0);
+        float sizeScale = textureLod(u_LifetimeCurves, vec2(coordinate, float(2 * emitter.lifetimeCurve + 1)), 0.0).r;
+
+        particleSize *= sizeScale;
+        // Premultiplied colors carry their alpha in rgb as well.
+        particleColor.rgb *= (u_BlendMode == BLEND_PREMULTIPLIED) ? colorScale.rgb * colorScale.a : colorScale.rgb;
+        particleColor.a *= colorScale.a;
+    }
+
+    // Generate the quad corner for a 4-vertex triangle strip: (-,-), (+,-), (-,+), (+,+).
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1)) - 0.5;
 
-    // Scale the quad's vertex position by the particle size
-    vec3 scaledVertexPos = quadVertices * particleSize;
+    // Expand the quad along the camera's right and up vectors so it always faces the camera.
+    vec3 billboardOffset = (emitter.cameraRight.xyz * corner.x + emitter.cameraUp.xyz * corner.y) * particleSize;
 
-    // Move the scaled quad vertex to the particle's position
-    vec3 finalPosition = particlePosition + scaledVertexPos;
+    // Move the billboarded quad vertex to the particle's position
+    vec3 finalPosition = particlePosition + billboardOffset;
 
-    // Calculate the final position
-    gl_Position = u_ProjectionMatrix * u_ViewMatrix * u_ModelMatrix * vec4(finalPosition, 1.0);
+    // Calculate the final position with the precomputed model-view-projection.
+    gl_Position = emitter.modelViewProjection * vec4(finalPosition, 1.0);
 
-    fragColor = aColor;
-}
\ No newline at end of file
+    fragColor = particleColor;
+}
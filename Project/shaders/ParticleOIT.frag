@@ -0,0 +1,24 @@
+#version 460 core
+
+in vec4 fragColor;
+
+layout (location = 0) out vec4 accum;
+layout (location = 1) out float revealage;
+
+// Matches the BlendMode enum on the CPU.
+const int BLEND_PREMULTIPLIED = 2;
+
+uniform int u_BlendMode;
+
+void main()
+{
+    // Depth weight from McGuire and Bavoil: closer and more opaque fragments dominate the average.
+    float weight = clamp(pow(min(1.0, fragColor.a * 10.0) + 0.01, 3.0) * 1e8 *
+                         pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);
+
+    // Premultiplied colors are already scaled by alpha.
+    vec3 premultipliedColor = (u_BlendMode == BLEND_PREMULTIPLIED) ? fragColor.rgb : fragColor.rgb * fragColor.a;
+
+    accum = vec4(premultipliedColor, fragColor.a) * weight;
+    revealage = fragColor.a;
+}
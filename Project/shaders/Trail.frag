@@ -0,0 +1,11 @@
+#version 460 core
+
+in vec4 fragColor;
+
+out vec4 color;
+
+void main()
+{
+    // Already premultiplied by the vertex shader.
+    color = fragColor;
+}
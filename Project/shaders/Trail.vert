@@ -0,0 +1,77 @@
+#version 460 core
+
+out vec4 fragColor;
+
+// Per-trail-draw data computed on the CPU once per frame, indexed by gl_DrawID.
+struct TrailDrawData {
+    mat4 modelViewProjection;
+    vec4 cameraForward;
+    int firstPoint;
+    int pointsPerTrail;
+    float width;
+    int blendMode;
+};
+
+layout (std430, binding = 6) readonly buffer TrailData {
+    TrailDrawData u_Trails[];
+};
+
+// Particle data shared with Particle.vert; the trail's base instance is its emitter's first particle.
+layout (std430, binding = 1) readonly buffer ParticlePositions {
+    vec4 u_ParticlePositions[];
+};
+
+layout (std430, binding = 2) readonly buffer ParticleColors {
+    uint u_ParticleColors[];
+};
+
+// Every visible particle's trail points, oldest first.
+layout (std430, binding = 5) readonly buffer TrailPoints {
+    vec4 u_TrailPoints[];
+};
+
+// Matches the BlendMode enum on the CPU.
+const int BLEND_ADDITIVE = 1;
+const int BLEND_PREMULTIPLIED = 2;
+const int BLEND_OPAQUE = 3;
+
+void main()
+{
+    TrailDrawData trail = u_Trails[gl_DrawID];
+    int particleIndex = gl_BaseInstance + gl_InstanceID;
+    int firstPoint = trail.firstPoint + gl_InstanceID * trail.pointsPerTrail;
+
+    // A strip of 2 vertices per point, alternating sides of the ribbon.
+    int point = gl_VertexID >> 1;
+    float side = float(gl_VertexID & 1) - 0.5;
+
+    vec3 position = u_TrailPoints[firstPoint + point].xyz;
+    vec3 previous = u_TrailPoints[firstPoint + max(point - 1, 0)].xyz;
+    vec3 next = u_TrailPoints[firstPoint + min(point + 1, trail.pointsPerTrail - 1)].xyz;
+
+    // Widen across the trail and the view direction so the ribbon faces the camera. Points that
+    // have not moved yet collapse to zero width.
+    vec3 across = cross(next - previous, trail.cameraForward.xyz);
+    float acrossLength = length(across);
+    across = acrossLength > 1e-6 ? across / acrossLength : vec3(0.0);
+
+    // Taper and fade toward the oldest point.
+    float age = float(point) / float(trail.pointsPerTrail - 1);
+    float width = u_ParticlePositions[particleIndex].w * trail.width * age;
+    gl_Position = trail.modelViewProjection * vec4(position + across * side * width, 1.0);
+
+    // Output premultiplied color, so one blend function serves every emitter: additive trails
+    // write zero alpha and only add their color.
+    vec4 color = unpackUnorm4x8(u_ParticleColors[particleIndex]);
+    if (trail.blendMode == BLEND_OPAQUE) {
+        color.a = 1.0;
+    }
+    if (trail.blendMode != BLEND_PREMULTIPLIED) {
+        color.rgb *= color.a;
+    }
+    color *= age;
+    if (trail.blendMode == BLEND_ADDITIVE) {
+        color.a = 0.0;
+    }
+    fragColor = color;
+}
@@ -0,0 +1,114 @@
+// MappedFile.cpp - Source file for read-only memory-mapped files.
+#include "MappedFile.hpp"
+
+#include <iostream>
+
+#if defined(MINGW) || defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+#if defined(MINGW) || defined(_WIN32)
+
+/**
+ * Maps a file with a read-only file mapping object.
+ */
+bool MappedFile::Open(const std::string& fileName) {
+    Close();
+
+    HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cout << "Could not open " << fileName << " for mapping" << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        std::cout << "Could not map empty or unreadable file " << fileName << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!view) {
+        std::cout << "Could not map " << fileName << std::endl;
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_mappingHandle = mapping;
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = (size_t)size.QuadPart;
+    return true;
+}
+
+/**
+ * Unmaps the view and closes the mapping and file handles.
+ */
+void MappedFile::Close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mappingHandle) CloseHandle((HANDLE)m_mappingHandle);
+    if (m_fileHandle) CloseHandle((HANDLE)m_fileHandle);
+    m_data = nullptr;
+    m_size = 0;
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+}
+
+#else
+
+/**
+ * Maps a file with mmap.
+ */
+bool MappedFile::Open(const std::string& fileName) {
+    Close();
+
+    int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        std::cout << "Could not open " << fileName << " for mapping" << std::endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fileDescriptor, &status) != 0 || status.st_size == 0) {
+        std::cout << "Could not map empty or unreadable file " << fileName << std::endl;
+        close(fileDescriptor);
+        return false;
+    }
+
+    void* view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (view == MAP_FAILED) {
+        std::cout << "Could not map " << fileName << std::endl;
+        close(fileDescriptor);
+        return false;
+    }
+
+    m_fileDescriptor = fileDescriptor;
+    m_data = static_cast<const unsigned char*>(view);
+    m_size = (size_t)status.st_size;
+    return true;
+}
+
+/**
+ * Unmaps the file and closes its descriptor.
+ */
+void MappedFile::Close() {
+    if (m_data) munmap(const_cast<unsigned char*>(m_data), m_size);
+    if (m_fileDescriptor >= 0) close(m_fileDescriptor);
+    m_data = nullptr;
+    m_size = 0;
+    m_fileDescriptor = -1;
+}
+
+#endif
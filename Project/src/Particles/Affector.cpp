@@ -0,0 +1,229 @@
+// Affector.cpp - Source file for the batched particle force affectors.
+
+#include <cmath>
+
+#include "../include/Particles/Affector.hpp"
+
+Affector Affector::Gravity(const glm::vec3& acceleration) {
+    Affector affector;
+    affector.type = AffectorType::Gravity;
+    affector.vector = acceleration;
+    return affector;
+}
+
+Affector Affector::LinearDrag(float coefficient) {
+    Affector affector;
+    affector.type = AffectorType::LinearDrag;
+    affector.strength = coefficient;
+    return affector;
+}
+
+Affector Affector::QuadraticDrag(float coefficient) {
+    Affector affector;
+    affector.type = AffectorType::QuadraticDrag;
+    affector.strength = coefficient;
+    return affector;
+}
+
+Affector Affector::Wind(const glm::vec3& velocity, float coupling) {
+    Affector affector;
+    affector.type = AffectorType::Wind;
+    affector.vector = velocity;
+    affector.strength = coupling;
+    return affector;
+}
+
+Affector Affector::PointAttractor(const glm::vec3& position, float strength, float radius) {
+    Affector affector;
+    affector.type = AffectorType::PointAttractor;
+    affector.position = position;
+    affector.strength = strength;
+    affector.radius = radius;
+    return affector;
+}
+
+Affector Affector::Vortex(const glm::vec3& position, const glm::vec3& axis, float strength, float radius) {
+    Affector affector;
+    affector.type = AffectorType::Vortex;
+    affector.position = position;
+    affector.vector = glm::normalize(axis);
+    affector.strength = strength;
+    affector.radius = radius;
+    return affector;
+}
+
+Affector Affector::Turbulence(const FieldVolume<glm::vec3>* noise, float strength, const glm::vec3& offset) {
+    Affector affector;
+    affector.type = AffectorType::Turbulence;
+    affector.field = noise;
+    affector.strength = strength;
+    affector.position = offset;
+    return affector;
+}
+
+Affector Affector::FlowField(const FieldVolume<glm::vec3>* velocities, float coupling) {
+    Affector affector;
+    affector.type = AffectorType::FlowField;
+    affector.field = velocities;
+    affector.strength = coupling;
+    return affector;
+}
+
+Affector Affector::ForceField(const FieldVolume<glm::vec3>* forces, float strength) {
+    Affector affector;
+    affector.type = AffectorType::ForceField;
+    affector.field = forces;
+    affector.strength = strength;
+    return affector;
+}
+
+/**
+ * Adds a constant acceleration to the velocities of a span of particles.
+ */
+void ApplyGravity(Particle* particles, int count, const glm::vec3& acceleration, float deltaTime) {
+    glm::vec3 deltaVelocity = acceleration * deltaTime;
+    for (int i = 0; i < count; i++) {
+        particles[i].speed += deltaVelocity;
+    }
+}
+
+/**
+ * Exponential decay, exact for any time step.
+ */
+static void ApplyLinearDrag(Particle* particles, int count, float coefficient, float deltaTime) {
+    float factor = std::exp(-coefficient * deltaTime);
+    for (int i = 0; i < count; i++) {
+        particles[i].speed *= factor;
+    }
+}
+
+/**
+ * Implicit update of dv/dt = -k|v|v, which stays stable for large speeds and time steps.
+ */
+static void ApplyQuadraticDrag(Particle* particles, int count, float coefficient, float deltaTime) {
+    float k = coefficient * deltaTime;
+    for (int i = 0; i < count; i++) {
+        glm::vec3& v = particles[i].speed;
+        v *= 1.0f / (1.0f + k * glm::length(v));
+    }
+}
+
+/**
+ * Relaxes each velocity toward the wind velocity at the given coupling rate.
+ */
+static void ApplyWind(Particle* particles, int count, const glm::vec3& windVelocity, float coupling, float deltaTime) {
+    float blend = 1.0f - std::exp(-coupling * deltaTime);
+    for (int i = 0; i < count; i++) {
+        particles[i].speed += (windVelocity - particles[i].speed) * blend;
+    }
+}
+
+/**
+ * Softened inverse-square attraction. Particles outside the radius are masked out without branching.
+ */
+static void ApplyPointAttractor(Particle* particles, int count, const Affector& affector, float deltaTime) {
+    const float softening = 0.01f;
+    float radiusSquared = affector.radius > 0.0f ? affector.radius * affector.radius : INFINITY;
+    float scale = affector.strength * deltaTime;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 toCenter = affector.position - particles[i].pos;
+        float distanceSquared = glm::dot(toCenter, toCenter);
+        float inverseDistance = 1.0f / std::sqrt(distanceSquared + softening);
+        float mask = distanceSquared < radiusSquared ? 1.0f : 0.0f;
+        particles[i].speed += toCenter * (scale * mask * inverseDistance * inverseDistance * inverseDistance);
+    }
+}
+
+/**
+ * Pushes particles tangentially around the vortex axis, fading linearly to zero at the radius.
+ */
+static void ApplyVortex(Particle* particles, int count, const Affector& affector, float deltaTime) {
+    float inverseRadius = affector.radius > 0.0f ? 1.0f / affector.radius : 0.0f;
+    float scale = affector.strength * deltaTime;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 offset = particles[i].pos - affector.position;
+        glm::vec3 radial = offset - affector.vector * glm::dot(offset, affector.vector);
+        float falloff = glm::max(0.0f, 1.0f - glm::length(radial) * inverseRadius);
+        particles[i].speed += glm::cross(affector.vector, radial) * (scale * falloff);
+    }
+}
+
+/**
+ * Accelerates particles along the curl-noise volume. The volume tiles, so it covers any extent,
+ * and each particle costs one trilinear lookup instead of an analytic noise evaluation.
+ */
+static void ApplyTurbulence(Particle* particles, int count, const Affector& affector, float deltaTime) {
+    const FieldVolume<glm::vec3>& noise = *affector.field;
+    float scale = affector.strength * deltaTime;
+    for (int i = 0; i < count; i++) {
+        particles[i].speed += noise.Sample(particles[i].pos + affector.position) * scale;
+    }
+}
+
+/**
+ * Relaxes velocities toward the field's velocity like wind that varies in space. Particles outside
+ * the field's bounds are left alone.
+ */
+static void ApplyFlowField(Particle* particles, int count, const Affector& affector, float deltaTime) {
+    const FieldVolume<glm::vec3>& field = *affector.field;
+    float blend = 1.0f - std::exp(-affector.strength * deltaTime);
+    for (int i = 0; i < count; i++) {
+        float mask = field.Contains(particles[i].pos) ? blend : 0.0f;
+        particles[i].speed += (field.Sample(particles[i].pos) - particles[i].speed) * mask;
+    }
+}
+
+/**
+ * Accelerates particles by the field's vector. Particles outside the field's bounds are left alone.
+ */
+static void ApplyForceField(Particle* particles, int count, const Affector& affector, float deltaTime) {
+    const FieldVolume<glm::vec3>& field = *affector.field;
+    float scale = affector.strength * deltaTime;
+    for (int i = 0; i < count; i++) {
+        float mask = field.Contains(particles[i].pos) ? scale : 0.0f;
+        particles[i].speed += field.Sample(particles[i].pos) * mask;
+    }
+}
+
+/**
+ * Applies each affector in order to the velocities of a contiguous span of live particles.
+ */
+void ApplyAffectors(const std::vector<Affector>& affectors, Particle* particles, int count, float deltaTime) {
+    for (const Affector& affector : affectors) {
+        switch (affector.type) {
+            case AffectorType::Gravity:
+                ApplyGravity(particles, count, affector.vector, deltaTime);
+                break;
+            case AffectorType::LinearDrag:
+                ApplyLinearDrag(particles, count, affector.strength, deltaTime);
+                break;
+            case AffectorType::QuadraticDrag:
+                ApplyQuadraticDrag(particles, count, affector.strength, deltaTime);
+                break;
+            case AffectorType::Wind:
+                ApplyWind(particles, count, affector.vector, affector.strength, deltaTime);
+                break;
+            case AffectorType::PointAttractor:
+                ApplyPointAttractor(particles, count, affector, deltaTime);
+                break;
+            case AffectorType::Vortex:
+                ApplyVortex(particles, count, affector, deltaTime);
+                break;
+            case AffectorType::Turbulence:
+                if (affector.field) {
+                    ApplyTurbulence(particles, count, affector, deltaTime);
+                }
+                break;
+            case AffectorType::FlowField:
+                if (affector.field) {
+                    ApplyFlowField(particles, count, affector, deltaTime);
+                }
+                break;
+            case AffectorType::ForceField:
+                if (affector.field) {
+                    ApplyForceField(particles, count, affector, deltaTime);
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,155 @@
+// Collider.cpp - Source file for the batched particle colliders.
+
+#include <algorithm>
+#include <cmath>
+
+#include "../include/Particles/Collider.hpp"
+
+Collider Collider::Plane(const glm::vec3& point, const glm::vec3& normal, float restitution, float friction) {
+    Collider collider;
+    collider.type = ColliderType::Plane;
+    collider.position = point;
+    collider.normal = glm::normalize(normal);
+    collider.restitution = restitution;
+    collider.friction = friction;
+    return collider;
+}
+
+Collider Collider::Sphere(const glm::vec3& center, float radius, float restitution, float friction) {
+    Collider collider;
+    collider.type = ColliderType::Sphere;
+    collider.position = center;
+    collider.radius = radius;
+    collider.restitution = restitution;
+    collider.friction = friction;
+    return collider;
+}
+
+Collider Collider::Box(const glm::vec3& center, const glm::vec3& halfExtents, const glm::mat3& rotation,
+                       float restitution, float friction) {
+    Collider collider;
+    collider.type = ColliderType::Box;
+    collider.position = center;
+    collider.halfExtents = halfExtents;
+    collider.rotation = rotation;
+    collider.restitution = restitution;
+    collider.friction = friction;
+    return collider;
+}
+
+/**
+ * Reflects the normal velocity of a particle still moving into a surface and damps its tangential
+ * velocity by the friction.
+ */
+void ResolveContact(Particle& p, const glm::vec3& normal, float restitution, float friction) {
+    float normalSpeed = glm::dot(p.speed, normal);
+    if (normalSpeed < 0.0f) {
+        glm::vec3 tangential = p.speed - normal * normalSpeed;
+        p.speed = tangential * (1.0f - friction) - normal * (normalSpeed * restitution);
+        p.collided = true;
+    }
+}
+
+static int CollidePlane(const Collider& collider, Particle* particles, int count) {
+    // Signed distance to the plane is dot(n, p) - d.
+    float d = glm::dot(collider.normal, collider.position);
+    int contacts = 0;
+    for (int i = 0; i < count; i++) {
+        float distance = glm::dot(collider.normal, particles[i].pos) - d;
+        if (distance >= 0.0f) {
+            continue;
+        }
+        contacts++;
+        if (collider.killOnContact) {
+            particles[i].life = 0.0f;
+            particles[i].collided = true;
+        } else {
+            particles[i].pos -= collider.normal * distance;
+            ResolveContact(particles[i], collider.normal, collider.restitution, collider.friction);
+        }
+    }
+    return contacts;
+}
+
+static int CollideSphere(const Collider& collider, Particle* particles, int count) {
+    float radiusSquared = collider.radius * collider.radius;
+    int contacts = 0;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 offset = particles[i].pos - collider.position;
+        float distanceSquared = glm::dot(offset, offset);
+        if (distanceSquared >= radiusSquared) {
+            continue;
+        }
+        contacts++;
+        if (collider.killOnContact) {
+            particles[i].life = 0.0f;
+            particles[i].collided = true;
+        } else {
+            float distance = std::sqrt(distanceSquared);
+            // A particle exactly at the center is pushed out upward.
+            glm::vec3 normal = distance > 1e-6f ? offset / distance : glm::vec3(0.0f, 1.0f, 0.0f);
+            particles[i].pos += normal * (collider.radius - distance);
+            ResolveContact(particles[i], normal, collider.restitution, collider.friction);
+        }
+    }
+    return contacts;
+}
+
+static int CollideBox(const Collider& collider, Particle* particles, int count) {
+    glm::mat3 inverseRotation = glm::transpose(collider.rotation);
+    int contacts = 0;
+    for (int i = 0; i < count; i++) {
+        glm::vec3 local = inverseRotation * (particles[i].pos - collider.position);
+        glm::vec3 depth = collider.halfExtents - glm::abs(local);
+        if (depth.x <= 0.0f || depth.y <= 0.0f || depth.z <= 0.0f) {
+            continue;
+        }
+        contacts++;
+        if (collider.killOnContact) {
+            particles[i].life = 0.0f;
+            particles[i].collided = true;
+            continue;
+        }
+
+        // Leave through the nearest face.
+        int axis = 0;
+        if (depth.y < depth[axis]) {
+            axis = 1;
+        }
+        if (depth.z < depth[axis]) {
+            axis = 2;
+        }
+        glm::vec3 normal = collider.rotation[axis] * (local[axis] < 0.0f ? -1.0f : 1.0f);
+        particles[i].pos += normal * depth[axis];
+        ResolveContact(particles[i], normal, collider.restitution, collider.friction);
+    }
+    return contacts;
+}
+
+/**
+ * Pushes particles out of each collider and reflects their velocities. Particles touching a
+ * kill-on-contact collider get their life set to zero so the caller can retire them.
+ */
+int ApplyColliders(const std::vector<Collider>& colliders, Particle* particles, int count, int firstKillable) {
+    int killed = 0;
+    for (const Collider& collider : colliders) {
+        // Kill-on-contact colliders skip the particles the caller cannot retire.
+        int first = collider.killOnContact ? std::min(firstKillable, count) : 0;
+        int contacts = 0;
+        switch (collider.type) {
+            case ColliderType::Plane:
+                contacts = CollidePlane(collider, particles + first, count - first);
+                break;
+            case ColliderType::Sphere:
+                contacts = CollideSphere(collider, particles + first, count - first);
+                break;
+            case ColliderType::Box:
+                contacts = CollideBox(collider, particles + first, count - first);
+                break;
+        }
+        if (collider.killOnContact) {
+            killed += contacts;
+        }
+    }
+    return killed;
+}
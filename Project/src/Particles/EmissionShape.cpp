@@ -0,0 +1,206 @@
+// EmissionShape.cpp - Source file for the shapes particles are spawned from.
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/random.hpp>
+
+#include "../include/Particles/EmissionShape.hpp"
+#include "../include/Physics/MeshCollider.hpp"
+
+static const float TWO_PI = 6.28318530718f;
+
+/**
+ * Loads the triangles of an OBJ file and builds the sampling table.
+ */
+bool EmissionMesh::LoadOBJ(const std::string& fileName, const glm::mat4& transform) {
+    std::vector<glm::vec3> vertices;
+    std::vector<int> indices;
+    if (!LoadOBJTriangles(fileName, transform, vertices, indices)) {
+        return false;
+    }
+
+    SetTriangles(vertices, indices);
+    return true;
+}
+
+/**
+ * Replaces the mesh and accumulates the triangles' areas. Degenerate triangles could never be
+ * picked, so they are left out of the table.
+ */
+void EmissionMesh::SetTriangles(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices) {
+    m_triangles.clear();
+    m_cumulativeArea.clear();
+    m_triangles.reserve(indices.size() / 3);
+    m_cumulativeArea.reserve(indices.size() / 3);
+
+    float totalArea = 0.0f;
+    for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+        Triangle triangle;
+        triangle.v0 = vertices[indices[t]];
+        triangle.e1 = vertices[indices[t + 1]] - triangle.v0;
+        triangle.e2 = vertices[indices[t + 2]] - triangle.v0;
+
+        glm::vec3 cross = glm::cross(triangle.e1, triangle.e2);
+        float doubleArea = glm::length(cross);
+        if (doubleArea <= 0.0f) {
+            continue;
+        }
+        triangle.normal = cross / doubleArea;
+
+        totalArea += 0.5f * doubleArea;
+        m_triangles.push_back(triangle);
+        m_cumulativeArea.push_back(totalArea);
+    }
+}
+
+/**
+ * Picks a triangle with probability proportional to its area by binary searching the running
+ * totals, then a uniform point inside it.
+ */
+void EmissionMesh::Sample(glm::vec3& position, glm::vec3& normal) const {
+    float target = glm::linearRand(0.0f, m_cumulativeArea.back());
+    int index = std::upper_bound(m_cumulativeArea.begin(), m_cumulativeArea.end(), target) - m_cumulativeArea.begin();
+    const Triangle& triangle = m_triangles[std::min(index, (int)m_triangles.size() - 1)];
+
+    // Fold points from the far half of the parallelogram back into the triangle.
+    float u = glm::linearRand(0.0f, 1.0f);
+    float v = glm::linearRand(0.0f, 1.0f);
+    if (u + v > 1.0f) {
+        u = 1.0f - u;
+        v = 1.0f - v;
+    }
+    position = triangle.v0 + triangle.e1 * u + triangle.e2 * v;
+    normal = triangle.normal;
+}
+
+EmissionShape EmissionShape::Cone(const glm::vec3& apex, const glm::vec3& axis, float angle, float speed) {
+    EmissionShape shape;
+    shape.type = EmissionShapeType::Cone;
+    shape.position = apex;
+    shape.axis = glm::normalize(axis);
+    shape.angle = angle;
+    shape.speed = speed;
+    return shape;
+}
+
+EmissionShape EmissionShape::Sphere(const glm::vec3& center, float radius, float speed, bool surface) {
+    EmissionShape shape;
+    shape.type = EmissionShapeType::Sphere;
+    shape.position = center;
+    shape.radius = radius;
+    shape.speed = speed;
+    shape.surface = surface;
+    return shape;
+}
+
+EmissionShape EmissionShape::Hemisphere(const glm::vec3& center, const glm::vec3& axis, float radius, float speed, bool surface) {
+    EmissionShape shape = Sphere(center, radius, speed, surface);
+    shape.type = EmissionShapeType::Hemisphere;
+    shape.axis = glm::normalize(axis);
+    return shape;
+}
+
+EmissionShape EmissionShape::Box(const glm::vec3& center, const glm::vec3& halfExtents, const glm::vec3& axis, float speed) {
+    EmissionShape shape;
+    shape.type = EmissionShapeType::Box;
+    shape.position = center;
+    shape.halfExtents = halfExtents;
+    shape.axis = glm::normalize(axis);
+    shape.speed = speed;
+    return shape;
+}
+
+EmissionShape EmissionShape::Disc(const glm::vec3& center, const glm::vec3& axis, float radius, float speed) {
+    EmissionShape shape;
+    shape.type = EmissionShapeType::Disc;
+    shape.position = center;
+    shape.axis = glm::normalize(axis);
+    shape.radius = radius;
+    shape.speed = speed;
+    return shape;
+}
+
+EmissionShape EmissionShape::Line(const glm::vec3& start, const glm::vec3& end, const glm::vec3& axis, float speed) {
+    EmissionShape shape;
+    shape.type = EmissionShapeType::Line;
+    shape.position = start;
+    shape.end = end;
+    shape.axis = glm::normalize(axis);
+    shape.speed = speed;
+    return shape;
+}
+
+EmissionShape EmissionShape::MeshSurface(const EmissionMesh* mesh, float speed) {
+    EmissionShape shape;
+    shape.type = EmissionShapeType::MeshSurface;
+    shape.mesh = mesh;
+    shape.speed = speed;
+    return shape;
+}
+
+/**
+ * Builds two unit vectors perpendicular to a unit axis and to each other.
+ */
+static void GetPerpendicularAxes(const glm::vec3& axis, glm::vec3& tangent, glm::vec3& bitangent) {
+    glm::vec3 helper = std::fabs(axis.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    tangent = glm::normalize(glm::cross(axis, helper));
+    bitangent = glm::cross(axis, tangent);
+}
+
+/**
+ * Picks a spawn position and launch direction on a shape.
+ */
+void SampleEmissionShape(const EmissionShape& shape, glm::vec3& position, glm::vec3& direction) {
+    glm::vec3 tangent, bitangent;
+    switch (shape.type) {
+        case EmissionShapeType::Cone: {
+            position = shape.position;
+            direction = shape.axis;
+            if (shape.angle > 0.0f) {
+                // Uniform over the spherical cap within the angle.
+                float cosTheta = glm::linearRand(std::cos(shape.angle), 1.0f);
+                float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+                float phi = glm::linearRand(0.0f, TWO_PI);
+                GetPerpendicularAxes(shape.axis, tangent, bitangent);
+                direction = (tangent * std::cos(phi) + bitangent * std::sin(phi)) * sinTheta + shape.axis * cosTheta;
+            }
+            break;
+        }
+        case EmissionShapeType::Sphere:
+        case EmissionShapeType::Hemisphere: {
+            direction = glm::sphericalRand(1.0f);
+            if (shape.type == EmissionShapeType::Hemisphere && glm::dot(direction, shape.axis) < 0.0f) {
+                direction = -direction;
+            }
+            // The cube root spreads points evenly through the volume instead of bunching at the center.
+            float radius = shape.surface ? shape.radius : shape.radius * std::cbrt(glm::linearRand(0.0f, 1.0f));
+            position = shape.position + direction * radius;
+            break;
+        }
+        case EmissionShapeType::Box:
+            position = shape.position + glm::linearRand(-shape.halfExtents, shape.halfExtents);
+            direction = shape.axis;
+            break;
+        case EmissionShapeType::Disc: {
+            // The square root keeps the density even across the disc.
+            float radius = shape.radius * std::sqrt(glm::linearRand(0.0f, 1.0f));
+            float phi = glm::linearRand(0.0f, TWO_PI);
+            GetPerpendicularAxes(shape.axis, tangent, bitangent);
+            position = shape.position + (tangent * std::cos(phi) + bitangent * std::sin(phi)) * radius;
+            direction = shape.axis;
+            break;
+        }
+        case EmissionShapeType::Line:
+            position = glm::mix(shape.position, shape.end, glm::linearRand(0.0f, 1.0f));
+            direction = shape.axis;
+            break;
+        case EmissionShapeType::MeshSurface:
+            if (shape.mesh != nullptr && !shape.mesh->IsEmpty()) {
+                shape.mesh->Sample(position, direction);
+            } else {
+                position = shape.position;
+                direction = shape.axis;
+            }
+            break;
+    }
+}
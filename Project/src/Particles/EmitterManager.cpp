@@ -0,0 +1,656 @@
+// EmitterManager.cpp - Source file for the emitter manager class.
+
+#include <algorithm>
+
+#include "../include/Particles/EmitterManager.hpp"
+#include "Globals.hpp"
+
+using namespace std::chrono;
+
+// Texture unit of the lifetime curve table. Units 0 and 1 belong to the OIT targets and scene depth.
+static const int LIFETIME_CURVE_TEXTURE_UNIT = 2;
+
+/**
+ * Constructor - creates the particle shader program shared by every emitter and the shared buffers.
+ */
+EmitterManager::EmitterManager() {
+    // Create a single shader program for rendering all particles.
+    m_particleShader = new Shader();
+    std::string vertexShader = m_particleShader->LoadShaderAsString("./shaders/Particle.vert");
+    std::string fragmentShader = m_particleShader->LoadShaderAsString("./shaders/Particle.frag");
+    m_particleShader->CreateShaderProgram(vertexShader, fragmentShader);
+    m_shaderProgram = m_particleShader->GetShaderID();
+
+    // The OIT variant shares the vertex shader but writes to the accumulation targets.
+    m_particleOITShader = new Shader();
+    std::string oitFragmentShader = m_particleOITShader->LoadShaderAsString("./shaders/ParticleOIT.frag");
+    m_particleOITShader->CreateShaderProgram(vertexShader, oitFragmentShader);
+    m_oitShaderProgram = m_particleOITShader->GetShaderID();
+    m_oit = new WeightedBlendedOIT(g.gWindowWidth, g.gWindowHeight);
+
+    // GPU emitters share one compute program for their updates.
+    m_gpuParticleShader = new Shader();
+    std::string computeShader = m_gpuParticleShader->LoadShaderAsString("./shaders/GPUParticles.comp");
+    m_gpuParticleShader->CreateComputeProgram(computeShader);
+
+    // Trails are ribbons pulled from their own point buffer.
+    m_trailShader = new Shader();
+    std::string trailVertexShader = m_trailShader->LoadShaderAsString("./shaders/Trail.vert");
+    std::string trailFragmentShader = m_trailShader->LoadShaderAsString("./shaders/Trail.frag");
+    m_trailShader->CreateShaderProgram(trailVertexShader, trailFragmentShader);
+
+    // Both particle programs read the lifetime curve table from the same unit.
+    for (Shader* shader : { m_particleShader, m_particleOITShader }) {
+        glUseProgram(shader->GetShaderID());
+        glUniform1i(shader->GetUniformLocation("u_LifetimeCurves"), LIFETIME_CURVE_TEXTURE_UNIT);
+    }
+    glUseProgram(0);
+
+    // Initialize shared particle buffers.
+    InitializeBuffers();
+
+    m_lastTime = steady_clock::now();
+}
+
+/**
+ * Destructor - Delete emitters, VAO, buffers, and graphics pipeline.
+ */
+EmitterManager::~EmitterManager() {
+    for (ParticleEmitter* emitter : m_emitters) {
+        delete emitter;
+    }
+    for (GPUParticleEmitter* emitter : m_gpuEmitters) {
+        delete emitter;
+    }
+    for (GridFluidSolver* fluid : m_gridFluids) {
+        delete fluid;
+    }
+
+    if (m_VAO) glDeleteVertexArrays(1, &m_VAO);
+    if (m_positionBuffer) glDeleteBuffers(1, &m_positionBuffer);
+    if (m_colorBuffer) glDeleteBuffers(1, &m_colorBuffer);
+    if (m_ageBuffer) glDeleteBuffers(1, &m_ageBuffer);
+    if (m_indirectBuffer) glDeleteBuffers(1, &m_indirectBuffer);
+    if (m_emitterDataBuffer) glDeleteBuffers(1, &m_emitterDataBuffer);
+    if (m_trailPointBuffer) glDeleteBuffers(1, &m_trailPointBuffer);
+    if (m_trailIndirectBuffer) glDeleteBuffers(1, &m_trailIndirectBuffer);
+    if (m_trailDataBuffer) glDeleteBuffers(1, &m_trailDataBuffer);
+    if (m_sceneDepth.texture) glDeleteTextures(1, &m_sceneDepth.texture);
+    if (m_lifetimeCurveTexture) glDeleteTextures(1, &m_lifetimeCurveTexture);
+
+    // Deleting the shader also deletes its program.
+    delete m_particleShader;
+    delete m_particleOITShader;
+    delete m_oit;
+    delete m_gpuParticleShader;
+    delete m_trailShader;
+}
+
+/**
+ * Creates the VAO, the shared particle storage buffers, and the indirect draw buffers.
+ */
+void EmitterManager::InitializeBuffers() {
+    // Quad corners are generated from gl_VertexID and particle data is pulled from storage
+    // buffers, so the VAO has no attributes. The core profile still requires one to be bound.
+    glGenVertexArrays(1, &m_VAO);
+
+    // Create the shared particle storage buffers. Storage is allocated as emitters are added.
+    glGenBuffers(1, &m_positionBuffer);
+    glGenBuffers(1, &m_colorBuffer);
+    glGenBuffers(1, &m_ageBuffer);
+
+    // Create the indirect draw buffer and the per-draw emitter data buffer.
+    glGenBuffers(1, &m_indirectBuffer);
+    glGenBuffers(1, &m_emitterDataBuffer);
+
+    // Create the trail point, indirect draw, and per-draw trail data buffers.
+    glGenBuffers(1, &m_trailPointBuffer);
+    glGenBuffers(1, &m_trailIndirectBuffer);
+    glGenBuffers(1, &m_trailDataBuffer);
+}
+
+/**
+ * Grows the shared instance buffers so they can hold at least numInstances particles.
+ */
+void EmitterManager::ReserveInstances(int numInstances) {
+    if (numInstances <= m_instanceCapacity) {
+        return;
+    }
+    m_instanceCapacity = numInstances;
+
+    m_gpuParticleData.resize(m_instanceCapacity * 4);
+    m_gpuParticleColorData.resize(m_instanceCapacity * 4);
+    m_gpuParticleAgeData.resize(m_instanceCapacity);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_positionBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceCapacity * 4 * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_colorBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceCapacity * 4 * sizeof(GLubyte), NULL, GL_STREAM_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ageBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceCapacity * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
+}
+
+/**
+ * Grows the indirect command and emitter data buffers so they can hold at least numDraws draws.
+ */
+void EmitterManager::ReserveDraws(int numDraws) {
+    if (numDraws <= m_drawCapacity) {
+        return;
+    }
+    m_drawCapacity = std::max(numDraws, m_drawCapacity * 2);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, m_drawCapacity * sizeof(DrawArraysIndirectCommand), NULL, GL_STREAM_DRAW);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_emitterDataBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_drawCapacity * sizeof(EmitterDrawData), NULL, GL_STREAM_DRAW);
+}
+
+/**
+ * Grows the trail point buffer so it can hold at least numPoints points.
+ */
+void EmitterManager::ReserveTrailPoints(int numPoints) {
+    if (numPoints <= m_trailPointCapacity) {
+        return;
+    }
+    m_trailPointCapacity = numPoints;
+
+    m_trailPointData.resize(m_trailPointCapacity);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_trailPointBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, m_trailPointCapacity * sizeof(glm::vec4), NULL, GL_STREAM_DRAW);
+}
+
+/**
+ * Creates a new emitter and reserves room for its particles in the shared buffers.
+ */
+ParticleEmitter* EmitterManager::CreateEmitter(const glm::vec3& position, int maxParticles) {
+    ParticleEmitter* emitter = new ParticleEmitter(position, maxParticles);
+    m_emitters.push_back(emitter);
+
+    int totalParticles = 0;
+    for (ParticleEmitter* e : m_emitters) {
+        totalParticles += e->GetMaxParticles();
+    }
+    ReserveInstances(totalParticles);
+    ReserveDraws(m_emitters.size());
+
+    return emitter;
+}
+
+/**
+ * Removes and deletes an emitter. The shared buffers keep their capacity for reuse.
+ */
+void EmitterManager::DestroyEmitter(ParticleEmitter* emitter) {
+    auto it = std::find(m_emitters.begin(), m_emitters.end(), emitter);
+    if (it != m_emitters.end()) {
+        m_emitters.erase(it);
+        // Sub-emitters must stop reading the destroyed emitter's events.
+        for (ParticleEmitter* other : m_emitters) {
+            other->RemoveSubEmitterSources(emitter);
+        }
+        delete emitter;
+    }
+}
+
+/**
+ * Creates a new GPU emitter. Its buffers are its own, so the shared buffers are unaffected.
+ */
+GPUParticleEmitter* EmitterManager::CreateGPUEmitter(const glm::vec3& position, int maxParticles) {
+    GPUParticleEmitter* emitter = new GPUParticleEmitter(position, maxParticles);
+    m_gpuEmitters.push_back(emitter);
+    return emitter;
+}
+
+/**
+ * Removes and deletes a GPU emitter.
+ */
+void EmitterManager::DestroyGPUEmitter(GPUParticleEmitter* emitter) {
+    auto it = std::find(m_gpuEmitters.begin(), m_gpuEmitters.end(), emitter);
+    if (it != m_gpuEmitters.end()) {
+        m_gpuEmitters.erase(it);
+        delete emitter;
+    }
+}
+
+/**
+ * Creates a new grid fluid.
+ */
+GridFluidSolver* EmitterManager::CreateGridFluid(const GridFluidSettings& settings) {
+    GridFluidSolver* fluid = new GridFluidSolver(settings);
+    m_gridFluids.push_back(fluid);
+    return fluid;
+}
+
+/**
+ * Removes and deletes a grid fluid.
+ */
+void EmitterManager::DestroyGridFluid(GridFluidSolver* fluid) {
+    auto it = std::find(m_gridFluids.begin(), m_gridFluids.end(), fluid);
+    if (it != m_gridFluids.end()) {
+        m_gridFluids.erase(it);
+        delete fluid;
+    }
+}
+
+/**
+ * Updates every emitter and records one draw command per emitter with visible particles.
+ */
+void EmitterManager::UpdateEmitters(bool frustumCulling) {
+    // Calculate delta time since last update, once for all emitters.
+    steady_clock::time_point currentTime = steady_clock::now();
+    duration<float> deltaTime = currentTime - m_lastTime;
+    m_lastTime = currentTime;
+
+    // Calculate the view-projection matrix for frustum culling.
+    glm::mat4 viewMatrix = g.gCamera.GetViewMatrix();
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(75.0f), 
+                        (float)g.gWindowWidth / (float)g.gWindowHeight, 1.0f, 75.0f);
+    glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+
+    for (int i = 0; i < (int)BlendMode::Count; i++) {
+        m_pendingDraws[i].clear();
+    }
+    m_particleRenderCount = 0;
+
+    glm::vec3 cameraPosition = g.gCamera.GetCameraPosition();
+
+    // Fluids advance first so every emitter samples this frame's velocity.
+    for (GridFluidSolver* fluid : m_gridFluids) {
+        fluid->Step(deltaTime.count());
+    }
+
+    // Trails can be turned on at any time, so size their staging for the worst case every update.
+    int totalTrailPoints = 0;
+    for (ParticleEmitter* emitter : m_emitters) {
+        totalTrailPoints += emitter->GetMaxParticles() * emitter->GetTrailLength();
+    }
+    ReserveTrailPoints(totalTrailPoints);
+    m_trailPointCount = 0;
+    m_trailCommands.clear();
+    m_trailDrawData.clear();
+
+    // Rebake the lifetime curves if any emitter's changed.
+    UpdateLifetimeCurveTexture();
+    int numLifetimeCurves = 0;
+
+    // Each emitter writes its visible particles directly after the previous emitter's.
+    for (ParticleEmitter* emitter : m_emitters) {
+        // Emitters with curves own consecutive row pairs, in the order they were baked.
+        int lifetimeCurve = emitter->HasLifetimeCurves() ? numLifetimeCurves++ : -1;
+
+        // OIT and order-independent blend modes never need sorted particles.
+        bool sortParticles = !m_orderIndependentTransparency && emitter->RequiresSorting();
+
+        int offset = m_particleRenderCount;
+        int count = emitter->UpdateParticles(deltaTime.count(), frustumCulling, sortParticles,
+                                             viewProjectionMatrix, &m_gpuParticleData[4 * offset],
+                                             &m_gpuParticleColorData[4 * offset],
+                                             m_trailPointData.data() + m_trailPointCount,
+                                             &m_gpuParticleAgeData[offset]);
+        if (count == 0) {
+            continue;
+        }
+
+        PendingDraw draw;
+        draw.command.count = 4;
+        draw.command.instanceCount = count;
+        draw.command.first = 0;
+        draw.command.baseInstance = offset;
+        draw.data = GetEmitterDrawData(emitter->GetModelMatrix());
+        draw.data.lifetimeCurve = lifetimeCurve;
+        draw.cameraDistance = glm::length(emitter->GetPosition() - cameraPosition);
+        m_pendingDraws[(int)emitter->GetBlendMode()].push_back(draw);
+
+        // One ribbon instance per visible particle; the base instance finds the particle's size and color.
+        int trailLength = emitter->GetTrailLength();
+        if (trailLength >= 2) {
+            DrawArraysIndirectCommand trailCommand;
+            trailCommand.count = 2 * trailLength;
+            trailCommand.instanceCount = count;
+            trailCommand.first = 0;
+            trailCommand.baseInstance = offset;
+            m_trailCommands.push_back(trailCommand);
+
+            TrailDrawData trailData;
+            trailData.modelViewProjectionMatrix = draw.data.modelViewProjectionMatrix;
+            trailData.cameraForward = glm::vec4(glm::cross(glm::vec3(draw.data.cameraUp), glm::vec3(draw.data.cameraRight)), 0.0f);
+            trailData.firstPoint = m_trailPointCount;
+            trailData.pointsPerTrail = trailLength;
+            trailData.width = emitter->GetTrailWidth();
+            trailData.blendMode = (int)emitter->GetBlendMode();
+            m_trailDrawData.push_back(trailData);
+
+            m_trailPointCount += count * trailLength;
+        }
+
+        m_particleRenderCount += count;
+    }
+
+    // Draw sorted emitters back to front as well, so nearer emitters blend over farther ones.
+    if (!m_orderIndependentTransparency) {
+        for (BlendMode blendMode : { BlendMode::Alpha, BlendMode::Premultiplied }) {
+            std::vector<PendingDraw>& draws = m_pendingDraws[(int)blendMode];
+            std::sort(draws.begin(), draws.end(), [](const PendingDraw& a, const PendingDraw& b) {
+                return a.cameraDistance > b.cameraDistance;
+            });
+        }
+    }
+
+    // GPU emitters update in compute against the depth captured last frame; their draws wait on it.
+    if (!m_gpuEmitters.empty()) {
+        for (GPUParticleEmitter* emitter : m_gpuEmitters) {
+            emitter->Update(m_gpuParticleShader, deltaTime.count(), m_sceneDepth);
+        }
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+    }
+
+    // Flatten the groups into the command and draw data arrays that get uploaded.
+    m_drawCommands.clear();
+    m_drawData.clear();
+    for (int i = 0; i < (int)BlendMode::Count; i++) {
+        m_groupFirstDraw[i] = m_drawCommands.size();
+        m_groupDrawCount[i] = m_pendingDraws[i].size();
+        for (const PendingDraw& draw : m_pendingDraws[i]) {
+            m_drawCommands.push_back(draw.command);
+            m_drawData.push_back(draw.data);
+        }
+    }
+}
+
+/**
+ * Computes an emitter's model-view-projection and the camera's billboard axes in emitter space.
+ */
+EmitterDrawData EmitterManager::GetEmitterDrawData(const glm::mat4& model) {
+    const FrameUniforms& frame = g.gFrameUniforms;
+
+    // The rows of the view matrix's rotation are the camera's right and up vectors in world space.
+    glm::vec3 worldRight = glm::vec3(frame.viewMatrix[0][0], frame.viewMatrix[1][0], frame.viewMatrix[2][0]);
+    glm::vec3 worldUp = glm::vec3(frame.viewMatrix[0][1], frame.viewMatrix[1][1], frame.viewMatrix[2][1]);
+    glm::mat3 worldToEmitter = glm::inverse(glm::mat3(model));
+
+    EmitterDrawData data;
+    data.modelViewProjectionMatrix = frame.viewProjectionMatrix * model;
+    data.cameraRight = glm::vec4(worldToEmitter * worldRight, 0.0f);
+    data.cameraUp = glm::vec4(worldToEmitter * worldUp, 0.0f);
+    data.lifetimeCurve = -1;
+    data.padding[0] = data.padding[1] = data.padding[2] = 0;
+    return data;
+}
+
+/**
+ * Bakes the lifetime curves of every emitter that has them into the curve table, two rows per
+ * emitter in emitter order. Nothing is done unless an emitter's curves were set, or emitters with
+ * curves were added or removed, since the last bake.
+ */
+void EmitterManager::UpdateLifetimeCurveTexture() {
+    std::vector<std::pair<const ParticleEmitter*, unsigned int>> curves;
+    for (ParticleEmitter* emitter : m_emitters) {
+        if (emitter->HasLifetimeCurves()) {
+            curves.push_back(std::make_pair(emitter, emitter->GetLifetimeCurvesRevision()));
+        }
+    }
+    if (curves == m_bakedLifetimeCurves) {
+        return;
+    }
+    m_bakedLifetimeCurves = curves;
+    if (curves.empty()) {
+        return;
+    }
+
+    std::vector<glm::vec4> texels(2 * curves.size() * LIFETIME_CURVE_RESOLUTION);
+    int row = 0;
+    for (ParticleEmitter* emitter : m_emitters) {
+        if (emitter->HasLifetimeCurves()) {
+            emitter->GetLifetimeCurves().Bake(&texels[row * LIFETIME_CURVE_RESOLUTION],
+                                              &texels[(row + 1) * LIFETIME_CURVE_RESOLUTION]);
+            row += 2;
+        }
+    }
+
+    if (!m_lifetimeCurveTexture) {
+        glGenTextures(1, &m_lifetimeCurveTexture);
+    }
+    glBindTexture(GL_TEXTURE_1D_ARRAY, m_lifetimeCurveTexture);
+    glTexImage2D(GL_TEXTURE_1D_ARRAY, 0, GL_RGBA16F, LIFETIME_CURVE_RESOLUTION, row, 0, GL_RGBA, GL_FLOAT, texels.data());
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_1D_ARRAY, 0);
+}
+
+/**
+ * Issues the multi-draw for every emitter using the given blend mode.
+ */
+void EmitterManager::DrawBlendModeGroup(BlendMode blendMode, Shader* shader) {
+    int group = (int)blendMode;
+    if (m_groupDrawCount[group] == 0) {
+        return;
+    }
+
+    // gl_DrawID restarts at zero for every multi-draw call, so pass the group's first draw.
+    glUniform1i(shader->GetUniformLocation("u_DrawOffset"), m_groupFirstDraw[group]);
+    glUniform1i(shader->GetUniformLocation("u_BlendMode"), group);
+
+    const void* firstCommand = (const void*)(m_groupFirstDraw[group] * sizeof(DrawArraysIndirectCommand));
+    glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, firstCommand, m_groupDrawCount[group], 0);
+}
+
+/**
+ * Draws every GPU emitter using the given blend mode, then restores the shared buffer bindings.
+ */
+void EmitterManager::DrawGPUEmitters(BlendMode blendMode, Shader* shader) {
+    bool drawn = false;
+    for (GPUParticleEmitter* emitter : m_gpuEmitters) {
+        if (emitter->GetBlendMode() != blendMode) {
+            continue;
+        }
+        glUniform1i(shader->GetUniformLocation("u_BlendMode"), (int)blendMode);
+        emitter->Draw(shader, GetEmitterDrawData(emitter->GetModelMatrix()));
+        drawn = true;
+    }
+
+    if (drawn) {
+        BindSharedBuffers();
+    }
+}
+
+/**
+ * Uploads the trail points and renders every emitter's ribbons with one indirect multi-draw. Trails
+ * blend premultiplied and unsorted, after the transparent particles they trail behind.
+ */
+void EmitterManager::DrawTrails() {
+    if (m_trailCommands.empty()) {
+        return;
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_trailPointBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_trailPointCount * sizeof(glm::vec4), m_trailPointData.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, m_trailPointBuffer);
+
+    // Grow the per-draw buffers as emitters turn trails on.
+    int numDraws = m_trailCommands.size();
+    if (numDraws > m_trailDrawCapacity) {
+        m_trailDrawCapacity = std::max(numDraws, m_trailDrawCapacity * 2);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_trailIndirectBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, m_trailDrawCapacity * sizeof(DrawArraysIndirectCommand), NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_trailDataBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_trailDrawCapacity * sizeof(TrailDrawData), NULL, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_trailDataBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, numDraws * sizeof(TrailDrawData), m_trailDrawData.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, m_trailDataBuffer);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_trailIndirectBuffer);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, numDraws * sizeof(DrawArraysIndirectCommand), m_trailCommands.data());
+
+    glUseProgram(m_trailShader->GetShaderID());
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, 0, numDraws, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+    glUseProgram(m_shaderProgram);
+}
+
+/**
+ * Binds the shared particle, emitter data and indirect buffers used by the CPU emitters' draws.
+ */
+void EmitterManager::BindSharedBuffers() {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_emitterDataBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_positionBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_colorBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+}
+
+/**
+ * Copies the depth of the opaque scene into a texture for next frame's GPU depth collisions.
+ * GPU particles are drawn after the copy, so they never collide with themselves.
+ */
+void EmitterManager::CaptureSceneDepth() {
+    if (m_gpuEmitters.empty()) {
+        return;
+    }
+
+    if (!m_sceneDepth.texture || m_sceneDepthWidth != g.gWindowWidth || m_sceneDepthHeight != g.gWindowHeight) {
+        if (m_sceneDepth.texture) glDeleteTextures(1, &m_sceneDepth.texture);
+        m_sceneDepthWidth = g.gWindowWidth;
+        m_sceneDepthHeight = g.gWindowHeight;
+
+        glGenTextures(1, &m_sceneDepth.texture);
+        glBindTexture(GL_TEXTURE_2D, m_sceneDepth.texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, m_sceneDepthWidth, m_sceneDepthHeight, 0,
+                     GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_sceneDepth.texture);
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, m_sceneDepthWidth, m_sceneDepthHeight);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_sceneDepth.viewMatrix = g.gFrameUniforms.viewMatrix;
+    m_sceneDepth.projectionMatrix = g.gFrameUniforms.projectionMatrix;
+    m_sceneDepth.valid = true;
+}
+
+/**
+ * Render all emitters.
+ */
+void EmitterManager::RenderEmitters() {
+    // Clear the color and depth buffers to prepare for a new frame.
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+
+    if (m_drawCommands.empty() && m_gpuEmitters.empty()) {
+        return;
+    }
+
+    // Upload every emitter's particles in one call per buffer.
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_positionBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_particleRenderCount * 4 * sizeof(float), m_gpuParticleData.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_positionBuffer);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_colorBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_particleRenderCount * 4 * sizeof(unsigned char), m_gpuParticleColorData.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_colorBuffer);
+
+    // Ages are only read by emitters with lifetime curves, and the curves only change when rebaked.
+    if (!m_bakedLifetimeCurves.empty()) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_ageBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_particleRenderCount * sizeof(float), m_gpuParticleAgeData.data());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, m_ageBuffer);
+
+        glActiveTexture(GL_TEXTURE0 + LIFETIME_CURVE_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_1D_ARRAY, m_lifetimeCurveTexture);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // Upload the draw commands and the per-draw data, indexed by gl_DrawID in the shader.
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_indirectBuffer);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_drawCommands.size() * sizeof(DrawArraysIndirectCommand), m_drawCommands.data());
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_emitterDataBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_drawData.size() * sizeof(EmitterDrawData), m_drawData.data());
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_emitterDataBuffer);
+
+    // Use shader program. Camera matrices come from the frame uniform buffer bound at startup.
+    glUseProgram(m_shaderProgram);
+
+    // Bind VAO.
+    glBindVertexArray(m_VAO);
+
+    // Opaque particles first, with depth writes so everything behind them is rejected early.
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    DrawBlendModeGroup(BlendMode::Opaque, m_particleShader);
+    CaptureSceneDepth();
+    DrawGPUEmitters(BlendMode::Opaque, m_particleShader);
+
+    glEnable(GL_BLEND);
+    if (m_orderIndependentTransparency) {
+        m_oit->Resize(g.gWindowWidth, g.gWindowHeight);
+        m_oit->Begin();
+
+        // Lay down opaque depth in the OIT targets so hidden transparent fragments are rejected.
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        DrawBlendModeGroup(BlendMode::Opaque, m_particleShader);
+        DrawGPUEmitters(BlendMode::Opaque, m_particleShader);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_FALSE);
+        glEnable(GL_BLEND);
+
+        // Both alpha modes accumulate in any order.
+        glUseProgram(m_oitShaderProgram);
+        DrawBlendModeGroup(BlendMode::Alpha, m_particleOITShader);
+        DrawBlendModeGroup(BlendMode::Premultiplied, m_particleOITShader);
+        DrawGPUEmitters(BlendMode::Alpha, m_particleOITShader);
+        DrawGPUEmitters(BlendMode::Premultiplied, m_particleOITShader);
+
+        // The composite pass binds its own program and VAO.
+        m_oit->End();
+        glUseProgram(m_shaderProgram);
+        glBindVertexArray(m_VAO);
+    } else {
+        // Sorted transparency: depth tested against opaque particles but never written.
+        glDepthMask(GL_FALSE);
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        DrawBlendModeGroup(BlendMode::Alpha, m_particleShader);
+        DrawGPUEmitters(BlendMode::Alpha, m_particleShader);
+
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        DrawBlendModeGroup(BlendMode::Premultiplied, m_particleShader);
+        DrawGPUEmitters(BlendMode::Premultiplied, m_particleShader);
+    }
+
+    // Ribbons for every emitter with trails, depth tested but never written.
+    glDepthMask(GL_FALSE);
+    DrawTrails();
+
+    // Additive particles are order independent in either mode.
+    glDepthMask(GL_FALSE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    DrawBlendModeGroup(BlendMode::Additive, m_particleShader);
+    DrawGPUEmitters(BlendMode::Additive, m_particleShader);
+
+    glDepthMask(GL_TRUE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Unbind VAO.
+    glBindVertexArray(0);
+}
+
+/**
+ * Return the number of particles rendered by all emitters.
+ */
+int EmitterManager::GetNumParticlesRendered() {
+    return m_particleRenderCount;
+}
@@ -0,0 +1,124 @@
+// GPUParticleEmitter.cpp - Source file for emitters whose particles live and update on the GPU.
+
+#include <cmath>
+
+#include "../include/Particles/GPUParticleEmitter.hpp"
+
+// Matches local_size_x in GPUParticles.comp.
+static const int GPU_PARTICLE_GROUP_SIZE = 256;
+
+// Matches struct GPUParticle in GPUParticles.comp: position and life, velocity and size, packed color.
+static const int GPU_PARTICLE_STRIDE = 3 * 4 * sizeof(GLfloat);
+
+// The draw command followed by the compute pass's spawn counter.
+struct GPUDrawCommand {
+    DrawArraysIndirectCommand command;
+    GLuint spawned;
+};
+
+/**
+ * Constructor - allocates the particle state with every slot dead, plus the emitter's render and
+ * draw buffers.
+ */
+GPUParticleEmitter::GPUParticleEmitter(const glm::vec3& position, int maxParticles) : m_maxParticles(maxParticles) {
+    SetPosition(position);
+
+    glGenBuffers(1, &m_stateBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_stateBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_maxParticles * GPU_PARTICLE_STRIDE, NULL, GL_DYNAMIC_COPY);
+    // Zero life marks a slot as free.
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32F, GL_RED, GL_FLOAT, NULL);
+
+    glGenBuffers(1, &m_positionBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_positionBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_maxParticles * 4 * sizeof(GLfloat), NULL, GL_DYNAMIC_COPY);
+
+    glGenBuffers(1, &m_colorBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_colorBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)m_maxParticles * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+    glGenBuffers(1, &m_commandBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(GPUDrawCommand), NULL, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &m_emitterDataBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_emitterDataBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(EmitterDrawData), NULL, GL_STREAM_DRAW);
+}
+
+/**
+ * Destructor - deletes the emitter's buffers.
+ */
+GPUParticleEmitter::~GPUParticleEmitter() {
+    if (m_stateBuffer) glDeleteBuffers(1, &m_stateBuffer);
+    if (m_positionBuffer) glDeleteBuffers(1, &m_positionBuffer);
+    if (m_colorBuffer) glDeleteBuffers(1, &m_colorBuffer);
+    if (m_commandBuffer) glDeleteBuffers(1, &m_commandBuffer);
+    if (m_emitterDataBuffer) glDeleteBuffers(1, &m_emitterDataBuffer);
+}
+
+/**
+ * Resets the draw command and dispatches the compute update for this frame.
+ */
+void GPUParticleEmitter::Update(Shader* computeShader, float deltaTime, const SceneDepth& sceneDepth) {
+    // Spawns accumulate fractionally so the rate is independent of the frame rate.
+    float spawns = m_settings.emissionRate * deltaTime + m_spawnRemainder;
+    GLuint spawnCount = (GLuint)std::floor(spawns);
+    m_spawnRemainder = spawns - spawnCount;
+
+    // Four vertices per particle quad; the instance count and spawn counter are filled by the shader.
+    GPUDrawCommand command = { { 4, 0, 0, 0 }, 0 };
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(command), &command);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_positionBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_colorBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, m_stateBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, m_commandBuffer);
+
+    glUseProgram(computeShader->GetShaderID());
+    glUniform1f(computeShader->GetUniformLocation("u_DeltaTime"), deltaTime);
+    glUniform1ui(computeShader->GetUniformLocation("u_MaxParticles"), m_maxParticles);
+    glUniform1ui(computeShader->GetUniformLocation("u_SpawnCount"), spawnCount);
+    glUniform1ui(computeShader->GetUniformLocation("u_Seed"), m_frame++);
+    glUniform3f(computeShader->GetUniformLocation("u_Gravity"), m_settings.gravity.x, m_settings.gravity.y, m_settings.gravity.z);
+    glUniform1f(computeShader->GetUniformLocation("u_Spread"), m_settings.spread);
+    glUniform1i(computeShader->GetUniformLocation("u_Premultiplied"), m_blendMode == BlendMode::Premultiplied);
+
+    bool depthCollision = m_settings.depthCollision && sceneDepth.valid;
+    glUniform1i(computeShader->GetUniformLocation("u_DepthCollision"), depthCollision);
+    if (depthCollision) {
+        // View matrices are rigid, so rotating view-space normals back needs only the transpose.
+        glm::mat3 viewToEmitter = glm::inverse(glm::mat3(m_modelMatrix)) * glm::transpose(glm::mat3(sceneDepth.viewMatrix));
+        glm::mat4 inverseProjection = glm::inverse(sceneDepth.projectionMatrix);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, sceneDepth.texture);
+        glUniform1i(computeShader->GetUniformLocation("u_SceneDepth"), 0);
+        glUniformMatrix4fv(computeShader->GetUniformLocation("u_ModelMatrix"), 1, GL_FALSE, &m_modelMatrix[0][0]);
+        glUniformMatrix4fv(computeShader->GetUniformLocation("u_DepthViewMatrix"), 1, GL_FALSE, &sceneDepth.viewMatrix[0][0]);
+        glUniformMatrix4fv(computeShader->GetUniformLocation("u_DepthProjectionMatrix"), 1, GL_FALSE, &sceneDepth.projectionMatrix[0][0]);
+        glUniformMatrix4fv(computeShader->GetUniformLocation("u_InverseDepthProjectionMatrix"), 1, GL_FALSE, &inverseProjection[0][0]);
+        glUniformMatrix3fv(computeShader->GetUniformLocation("u_DepthViewToEmitter"), 1, GL_FALSE, &viewToEmitter[0][0]);
+        glUniform1f(computeShader->GetUniformLocation("u_CollisionThickness"), m_settings.collisionThickness);
+        glUniform1f(computeShader->GetUniformLocation("u_Restitution"), m_settings.restitution);
+        glUniform1f(computeShader->GetUniformLocation("u_Friction"), m_settings.friction);
+    }
+
+    glDispatchCompute((m_maxParticles + GPU_PARTICLE_GROUP_SIZE - 1) / GPU_PARTICLE_GROUP_SIZE, 1, 1);
+}
+
+/**
+ * Binds the emitter's particle and draw data and issues its indirect draw.
+ */
+void GPUParticleEmitter::Draw(Shader* shader, const EmitterDrawData& drawData) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_emitterDataBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(EmitterDrawData), &drawData);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_emitterDataBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_positionBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_colorBuffer);
+
+    glUniform1i(shader->GetUniformLocation("u_DrawOffset"), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+    glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, (const void*)0, 1, 0);
+}
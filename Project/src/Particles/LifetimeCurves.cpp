@@ -0,0 +1,61 @@
+// LifetimeCurves.cpp - Source file for color and size curves over a particle's life.
+
+#include <algorithm>
+
+#include "../include/Particles/LifetimeCurves.hpp"
+
+/**
+ * Sorts the keys by age.
+ */
+void LifetimeCurves::SortKeys() {
+    std::stable_sort(colorKeys.begin(), colorKeys.end(), [](const ColorKey& a, const ColorKey& b) {
+        return a.age < b.age;
+    });
+    std::stable_sort(sizeKeys.begin(), sizeKeys.end(), [](const SizeKey& a, const SizeKey& b) {
+        return a.age < b.age;
+    });
+}
+
+/**
+ * Interpolates between the keys on either side of age, holding the first and last values
+ * beyond the ends.
+ */
+template <typename Key, typename Value, typename GetValue>
+static Value EvaluateKeys(const std::vector<Key>& keys, float age, Value defaultValue, GetValue getValue) {
+    if (keys.empty()) {
+        return defaultValue;
+    }
+    if (age <= keys.front().age) {
+        return getValue(keys.front());
+    }
+    if (age >= keys.back().age) {
+        return getValue(keys.back());
+    }
+
+    auto next = std::upper_bound(keys.begin(), keys.end(), age, [](float a, const Key& key) {
+        return a < key.age;
+    });
+    auto previous = next - 1;
+    float span = next->age - previous->age;
+    float t = span > 0.0f ? (age - previous->age) / span : 1.0f;
+    return getValue(*previous) + (getValue(*next) - getValue(*previous)) * t;
+}
+
+glm::vec4 LifetimeCurves::EvaluateColor(float age) const {
+    return EvaluateKeys(colorKeys, age, glm::vec4(1.0f), [](const ColorKey& key) { return key.color; });
+}
+
+float LifetimeCurves::EvaluateSize(float age) const {
+    return EvaluateKeys(sizeKeys, age, 1.0f, [](const SizeKey& key) { return key.size; });
+}
+
+/**
+ * Samples both curves into lookup table rows.
+ */
+void LifetimeCurves::Bake(glm::vec4* colorTexels, glm::vec4* sizeTexels) const {
+    for (int i = 0; i < LIFETIME_CURVE_RESOLUTION; i++) {
+        float age = (float)i / (LIFETIME_CURVE_RESOLUTION - 1);
+        colorTexels[i] = EvaluateColor(age);
+        sizeTexels[i] = glm::vec4(EvaluateSize(age));
+    }
+}
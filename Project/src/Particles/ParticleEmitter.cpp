@@ -1,30 +1,29 @@
 // ParticleEmitter.hpp - Header file for the particle emitter class.
 
 #include <algorithm>
-#include <chrono>
 #include <fstream>
 #include <cmath>
 
 #include "../include/Particles/ParticleEmitter.hpp"
-#include "../include/Startup/Shader.hpp"
 #include "Globals.hpp"
 
-using namespace std::chrono;
-steady_clock::time_point lastTime = steady_clock::now();
+// Events a parent records per update when a sub-emitter subscribes to it.
+static const int DEFAULT_EVENT_CAPACITY = 1024;
+// Contacts slower than this, like particles resting on a floor, are not collision events.
+static const float COLLISION_EVENT_MIN_SPEED = 1.0f;
+
+// Shared by every emitter, so no two settings of any emitter's curves get the same revision.
+static unsigned int s_lifetimeCurvesRevision = 0;
 
 /**
- * Constructor - creates a particle shader program, sets up buffers, and initializes particle values.
+ * Constructor - initializes particle values. Rendering resources are owned by the EmitterManager.
+ * 
+ * @param position - the emitter's position in world space.
+ * @param maxParticles - the number of particle slots this emitter owns.
  */
-ParticleEmitter::ParticleEmitter() {
-    // Create a new shader program for rendering particles.
-    Shader* particleShader = new Shader();
-    std::string vertexShader = particleShader->LoadShaderAsString("./shaders/Particle.vert");
-    std::string fragmentShader = particleShader->LoadShaderAsString("./shaders/Particle.frag");
-    particleShader->CreateShaderProgram(vertexShader, fragmentShader);     
-    m_shaderProgram = particleShader->GetShaderID();  
-
-    // Initialize particle buffers.
-    InitializeBuffers();
+ParticleEmitter::ParticleEmitter(const glm::vec3& position, int maxParticles)
+    : m_particles(maxParticles), m_maxParticles(maxParticles) {
+    SetPosition(position);
 
     // Set all particles to negative life and camera distance.
     for(int i=0; i<m_maxParticles; i++){
@@ -34,93 +33,36 @@ ParticleEmitter::ParticleEmitter() {
 }
 
 /**
- * Destructor - Delete VAO, VBOs, and graphics pipeline.
+ * Destructor.
  */
 ParticleEmitter::~ParticleEmitter() {
-    if (m_VAO) glDeleteVertexArrays(1, &m_VAO);
-    if (m_VBO) glDeleteBuffers(1, &m_VBO);
-    if (m_positionBuffer) glDeleteBuffers(1, &m_positionBuffer);
-    if (m_colorBuffer) glDeleteBuffers(1, &m_colorBuffer);
-    if (m_shaderProgram) glDeleteProgram (m_shaderProgram);
 }
 
 /**
- * Declares a quad shape and creates a VAO, position, and color buffer.
- */
-void ParticleEmitter::InitializeBuffers() {
-    // Create Vertex Array Object.
-    glGenVertexArrays(1, &m_VAO);
-    glBindVertexArray(m_VAO);
-
-    // Declare two triangle vertices to make a quad.
-    static const GLfloat vertexData[] = {
-    -0.5f, -0.5f, 0.0f, // T1
-     0.5f, -0.5f, 0.0f,
-    -0.5f,  0.5f, 0.0f,
-    -0.5f,  0.5f, 0.0f, // T2
-     0.5f, -0.5f, 0.0f,
-     0.5f,  0.5f, 0.0f,
-    };
-
-    // Create a Vertex Buffer Object for quad data.
-    glGenBuffers(1, &m_VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertexData), vertexData, GL_STATIC_DRAW);
-
-    // Create a Vertex Buffer Object for particle positions.
-    glGenBuffers(1, &m_positionBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
-    glBufferData(GL_ARRAY_BUFFER, m_maxParticles * 4 * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
-
-    // Create a Vertex Buffer Object for particle colors.
-    glGenBuffers(1, &m_colorBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, m_colorBuffer);
-    glBufferData(GL_ARRAY_BUFFER, m_maxParticles * 4 * sizeof(GLubyte), NULL, GL_STREAM_DRAW);
-
-    // Declare vertex attributes - quad vertices.
-    glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Declare vertex attributes - particle positions.
-    glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
-    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    glEnableVertexAttribArray(1);
-
-    // Declare vertex attributes - particle colors.
-    glBindBuffer(GL_ARRAY_BUFFER, m_colorBuffer);
-    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, (void*)0);
-    glEnableVertexAttribArray(2);
-
-    // Unbind the VAO
-    glBindVertexArray(0);
-}
-
-/**
- * Iterate through the array of particles to find the first dead particle.
+ * Returns the slot for a new particle. Live particles are kept packed at the front of the array,
+ * so the first unused slot is always right after the last live particle.
+ * 
+ * @return - the slot, or -1 if ropes fill the whole emitter.
  */
 int ParticleEmitter::FindUnusedParticle() {
-    // Try to find an unused particle from the last used index.
-    // This will shorten the search time.
-    for (int i = m_lastUsedParticle; i < m_maxParticles; i++) {
-        if (m_particles[i].life <= 0.0) {
-            m_lastUsedParticle = i;
-            return i;
-        }
+    if (m_aliveCount < m_maxParticles) {
+        return m_aliveCount++;
     }
 
-    // If no particle was found from the last used...
-    // Conduct a linear search from the beginning of the array.
-    for (int i = 0; i < m_lastUsedParticle; i++) {
-        if (m_particles[i].life <= 0.0) {
-            m_lastUsedParticle = i;
-            return i;
-        }
-    }
+    // If all particles are alive, overwrite the first particle that is not part of a rope.
+    return m_linkedCount < m_maxParticles ? m_linkedCount : -1;
+}
 
-    // If all particles are alive, overwrite the first particle.
-    m_lastUsedParticle = 0;
-    return 0; 
+/**
+ * Removes a particle by moving the last live particle into its slot.
+ */
+void ParticleEmitter::KillParticle(int index) {
+    ReleaseTrail(m_particles[index]);
+    m_aliveCount--;
+    m_particles[index] = m_particles[m_aliveCount];
+    m_particles[m_aliveCount].life = -1.0f;
+    m_particles[m_aliveCount].cameraDistance = -1.0f;
+    m_particles[m_aliveCount].trail = -1;
 }
 
 /**
@@ -132,13 +74,21 @@ void ParticleEmitter::GenerateRandomParticles(int numParticles) {
 
         // Try to find first dead one to replace or first particle in array.
         int particleIndex = FindUnusedParticle();
+        if (particleIndex < 0) {
+            break;
+        }
 
-        // Life attribute - random number between 
-        m_particles[particleIndex].life = glm::linearRand(0.5f, 5.0f); // This particle will live 5 seconds.
-        m_particles[particleIndex].pos = glm::vec3(0,0,0);
+        // Pick the spawn point and launch direction from the emission shape.
+        glm::vec3 position, direction;
+        SampleEmissionShape(m_emissionShape, position, direction);
+        glm::vec3 initialDirection = direction * m_emissionShape.speed;
 
-        // Set the initial direction to upward to get the fountain effect.
-        glm::vec3 initialDirection = glm::vec3(0.0f, 10.0f, 0.0f);
+        // A point cloud replaces the shape's position with the next point in its range.
+        size_t point = m_pointCloudCursor;
+        if (m_pointCloud != nullptr) {
+            position = m_pointCloud->GetPosition(point);
+            m_pointCloudCursor = point + 1 < m_pointCloudEnd ? point + 1 : m_pointCloudFirst;
+        }
 
         // Create a random direction for all of the particles.
         glm::vec3 randomDirection = glm::vec3(
@@ -147,163 +97,478 @@ void ParticleEmitter::GenerateRandomParticles(int numParticles) {
             glm::linearRand(-1.0f, 1.0f)
         );
         
-        // Calculate particle speed.
-        m_particles[particleIndex].speed = initialDirection + randomDirection * m_spread;
+        // Calculate particle speed; the rest of the particle is randomized.
+        InitializeParticle(m_particles[particleIndex], position, initialDirection + randomDirection * m_spread);
+
+        if (m_pointCloud != nullptr && m_pointCloud->HasColors()) {
+            unsigned char rgba[4];
+            m_pointCloud->GetColor(point, rgba);
+            SetParticleColor(m_particles[particleIndex], rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+    }
+}
+
+/**
+ * Sets the range of points spawned from a point cloud. The range is clamped to the cloud, and an
+ * empty range turns the cloud off.
+ */
+void ParticleEmitter::SetPointCloud(const PointCloud* pointCloud, size_t first, size_t count) {
+    m_pointCloud = nullptr;
+    if (pointCloud == nullptr || first >= pointCloud->GetNumPoints() || count == 0) {
+        return;
+    }
+
+    m_pointCloud = pointCloud;
+    m_pointCloudFirst = first;
+    m_pointCloudEnd = first + std::min(count, pointCloud->GetNumPoints() - first);
+    m_pointCloudCursor = first;
+}
+
+/**
+ * Gives a new particle its position and velocity, and a random life, color, and size.
+ * 
+ * @param particle - the particle slot to fill.
+ * @param position - the spawn position, in emitter space.
+ * @param velocity - the initial velocity.
+ */
+void ParticleEmitter::InitializeParticle(Particle& particle, const glm::vec3& position, const glm::vec3& velocity) {
+    // Life attribute - random number between the emitter's minimum and maximum lifetimes.
+    particle.life = glm::linearRand(m_minLife, m_maxLife);
+    particle.lifetime = particle.life;
+    particle.pos = position;
+    particle.speed = velocity;
+    particle.collided = false;
+
+    // Generate Random Particle colors.
+    SetParticleColor(particle, glm::linearRand(0.0f, 256.0f), glm::linearRand(0.0f, 256.0f),
+                     glm::linearRand(0.0f, 256.0f), glm::linearRand(0.0f, 256.0f) / 3);
+
+    particle.size = glm::linearRand(0.1f, 0.6f);
+
+    // A recycled slot keeps its trail, which must not connect to the previous particle.
+    if (particle.trail >= 0) {
+        ResetTrail(particle.trail, position);
+    }
+}
+
+/**
+ * Sets the lifetime curves with their keys in order and marks them as changed.
+ */
+void ParticleEmitter::SetLifetimeCurves(const LifetimeCurves& curves) {
+    m_lifetimeCurves = curves;
+    m_lifetimeCurves.SortKeys();
+    m_lifetimeCurvesRevision = ++s_lifetimeCurvesRevision;
+}
+
+/**
+ * Sets a particle's color, premultiplying it for emitters that blend premultiplied.
+ */
+void ParticleEmitter::SetParticleColor(Particle& particle, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    particle.r = r;
+    particle.g = g;
+    particle.b = b;
+    particle.a = a;
+
+    // Premultiplied blending expects the color already scaled by alpha.
+    if (m_blendMode == BlendMode::Premultiplied) {
+        particle.r = particle.r * particle.a / 255;
+        particle.g = particle.g * particle.a / 255;
+        particle.b = particle.b * particle.a / 255;
+    }
+}
+
+/**
+ * Allocates one ring of trail points per particle slot, so trails never allocate while running.
+ * Live particles get their rings on the next update.
+ */
+void ParticleEmitter::EnableTrails(int length, float width, float sampleInterval) {
+    for (Particle& particle : m_particles) {
+        particle.trail = -1;
+    }
+
+    if (length < 2) {
+        m_trailLength = 0;
+        std::vector<glm::vec4>().swap(m_trailPoints);
+        std::vector<int>().swap(m_freeTrails);
+        return;
+    }
+
+    m_trailLength = length;
+    m_trailWidth = width;
+    m_trailSampleInterval = std::max(sampleInterval, 0.0f);
+    m_trailHead = 0;
+    m_trailTimer = 0.0f;
+    m_trailPoints.assign((size_t)m_maxParticles * length, glm::vec4(0.0f));
+
+    // Hand out low slots first.
+    m_freeTrails.clear();
+    m_freeTrails.reserve(m_maxParticles);
+    for (int i = m_maxParticles - 1; i >= 0; i--) {
+        m_freeTrails.push_back(i);
+    }
+}
+
+/**
+ * Collapses a trail onto a single position.
+ */
+void ParticleEmitter::ResetTrail(int trail, const glm::vec3& position) {
+    glm::vec4* ring = &m_trailPoints[(size_t)trail * m_trailLength];
+    for (int i = 0; i < m_trailLength; i++) {
+        ring[i] = glm::vec4(position, 1.0f);
+    }
+}
+
+/**
+ * Returns a particle's trail to the free list.
+ */
+void ParticleEmitter::ReleaseTrail(Particle& particle) {
+    if (particle.trail >= 0) {
+        m_freeTrails.push_back(particle.trail);
+        particle.trail = -1;
+    }
+}
+
+/**
+ * Records every live particle's position at the shared ring position. The rings advance in
+ * lockstep, so one head index describes all of them; between samples the newest point follows
+ * the particle.
+ */
+void ParticleEmitter::AdvanceTrails(float deltaTime) {
+    if (m_trailLength < 2) {
+        return;
+    }
+
+    m_trailTimer += deltaTime;
+    if (m_trailTimer >= m_trailSampleInterval) {
+        // Long frames advance one point rather than smearing a gap across several.
+        m_trailTimer = m_trailTimer >= 2.0f * m_trailSampleInterval ? 0.0f : m_trailTimer - m_trailSampleInterval;
+        m_trailHead = (m_trailHead + 1) % m_trailLength;
+    }
+
+    for (int i = 0; i < m_aliveCount; i++) {
+        Particle& p = m_particles[i];
+        if (p.trail < 0) {
+            if (m_freeTrails.empty()) {
+                continue;
+            }
+            p.trail = m_freeTrails.back();
+            m_freeTrails.pop_back();
+            ResetTrail(p.trail, p.pos);
+        }
+        m_trailPoints[(size_t)p.trail * m_trailLength + m_trailHead] = glm::vec4(p.pos, 1.0f);
+    }
+}
 
-        // Generate Random Particle colors.
-        m_particles[particleIndex].r = glm::linearRand(0.0f, 256.0f);
-        m_particles[particleIndex].g = glm::linearRand(0.0f, 256.0f);
-        m_particles[particleIndex].b = glm::linearRand(0.0f, 256.0f);
-        m_particles[particleIndex].a = glm::linearRand(0.0f, 256.0f) / 3;
+/**
+ * Registers a parent whose events this emitter spawns bursts from. The parent records up to
+ * DEFAULT_EVENT_CAPACITY events of the trigger type per update unless it already keeps more.
+ */
+void ParticleEmitter::AddSubEmitterSource(const SubEmitterSource& source) {
+    if (source.parent->GetEvents(source.trigger).GetCapacity() < DEFAULT_EVENT_CAPACITY) {
+        source.parent->SetEventCapacity(source.trigger, DEFAULT_EVENT_CAPACITY);
+    }
+    m_subEmitterSources.push_back(source);
+}
 
-        m_particles[particleIndex].size = glm::linearRand(0.1f, 0.6f);
+/**
+ * Removes every sub-emitter source that reads from parent.
+ */
+void ParticleEmitter::RemoveSubEmitterSources(const ParticleEmitter* parent) {
+    m_subEmitterSources.erase(std::remove_if(m_subEmitterSources.begin(), m_subEmitterSources.end(),
+        [parent](const SubEmitterSource& source) {
+            return source.parent == parent;
+        }), m_subEmitterSources.end());
+}
+
+/**
+ * Spawns a burst at each event recorded by the parents' latest updates. The events are read in
+ * one batch, and the spawn count is bounded by the parents' event capacities and by the free
+ * slots, so a burst never overwrites live particles.
+ */
+void ParticleEmitter::EmitSubEmitterBursts() {
+    for (const SubEmitterSource& source : m_subEmitterSources) {
+        const ParticleEventBuffer& events = source.parent->GetEvents(source.trigger);
+        // Events are in the parent's emitter space.
+        glm::vec3 offset = source.parent->GetPosition() - m_emitterPosition;
+
+        for (int i = 0; i < events.GetCount(); i++) {
+            const ParticleEvent& event = events.GetEvents()[i];
+            int burst = std::min(source.particlesPerEvent, m_maxParticles - m_aliveCount);
+            if (burst <= 0) {
+                return;
+            }
+            for (int j = 0; j < burst; j++) {
+                glm::vec3 velocity = event.velocity * source.inheritVelocity + glm::ballRand(source.speed);
+                InitializeParticle(m_particles[m_aliveCount++], event.position + offset, velocity);
+            }
+        }
     }
 }
 
 /**
- * Generates new particles each frame and updates the positions of the particles based on gravity and spread.
+ * Generates new particles each frame and updates the positions of the particles based on gravity, spread,
+ * and the emitter's affectors.
+ * Visible particles are packed into the caller's buffers, which the EmitterManager uploads in one batch.
  * 
+ * @param deltaTime - seconds elapsed since the last update.
  * @param frustumCulling - A boolean value used to decide if frustum culling is turned on/off.
+ * @param sortParticles - whether particles must be sorted back to front for alpha blending.
+ * @param viewProjectionMatrix - the camera's view-projection matrix used for culling.
+ * @param gpuParticleData - destination for 4 floats (position, size) per visible particle.
+ * @param gpuParticleColorData - destination for 4 bytes (rgba) per visible particle.
+ * @param gpuTrailData - destination for GetTrailLength() points per visible particle, oldest first.
+ * @param gpuParticleAgeData - destination for 1 float (normalized age) per visible particle.
+ * @return - the number of particles written.
  */
-void ParticleEmitter::UpdateParticles(bool frustumCulling) {
-    // Calculate the view-projection matrix for frustum culling.
-    glm::mat4 viewMatrix = g.gCamera.GetViewMatrix();
-    glm::mat4 projectionMatrix = glm::perspective(glm::radians(75.0f), 
-                        (float)g.gWindowWidth / (float)g.gWindowHeight, 1.0f, 75.0f);
-    glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
-
-    // Get the frustum planes.
-    GetFrustumPlanes(viewProjectionMatrix);
-
-    // Calculate delta time since last update.
-    steady_clock::time_point currentTime = steady_clock::now();
-    duration<float> deltaTime = currentTime - lastTime;
-    lastTime = currentTime;
-    float m_deltaTime = deltaTime.count();
-
-    // Retrieve the camera position.
-    glm::vec3 cameraPosition = g.gCamera.GetCameraPosition();
-
-    // Calculate the number of new particles to emit based on the elapsed time.
-    int newparticles = (int)(m_deltaTime * 10000.0);
-    if (newparticles > (int)(0.016f * 10000.0))
-        newparticles = (int)(0.016f * 10000.0);
-
-    // Create new particles to replace dead ones.
+int ParticleEmitter::UpdateParticles(float deltaTime, bool frustumCulling, bool sortParticles, const glm::mat4& viewProjectionMatrix,
+                                     float* gpuParticleData, unsigned char* gpuParticleColorData, glm::vec4* gpuTrailData,
+                                     float* gpuParticleAgeData) {
+    // Particles are simulated in emitter space, so cull against the emitter's model-view-projection.
+    GetFrustumPlanes(viewProjectionMatrix * m_modelMatrix);
+
+    // Retrieve the camera position in emitter space.
+    glm::vec3 cameraPosition = g.gCamera.GetCameraPosition() - m_emitterPosition;
+
+    // Calculate the number of new particles to emit based on the elapsed time. Fractions carry
+    // over so low rates still emit, but a long frame never emits more than 16 ms worth. The cap
+    // leaves room for one whole particle on top so the carried fraction is never thrown away.
+    m_emissionAccumulator += deltaTime * m_emissionRate;
+    m_emissionAccumulator = std::min(m_emissionAccumulator, 0.016f * m_emissionRate + 1.0f);
+    int newparticles = (int)m_emissionAccumulator;
+    m_emissionAccumulator -= newparticles;
+
+    // Create new particles to replace dead ones, then bursts from the parents' events.
     GenerateRandomParticles(newparticles);
+    EmitSubEmitterBursts();
 
-    // Prepare buffers for new particle data.
-    std::vector<float> gpuParticleData(m_maxParticles * 4, 0.0f);
-    std::vector<unsigned char> gpuParticleColorData(m_maxParticles * 4, 0);
+    // This update's events replace the last update's, which every child has consumed by now.
+    for (ParticleEventBuffer& events : m_events) {
+        events.Clear();
+    }
+    ParticleEventBuffer& deathEvents = m_events[(int)ParticleEventType::Death];
+
+    // Age particles, retiring dead ones so live particles stay contiguous. Linked particles never age.
+    for (int i = m_linkedCount; i < m_aliveCount; ) {
+        m_particles[i].life -= deltaTime;
+        if (m_particles[i].life > 0.0f) {
+            i++;
+        } else {
+            deathEvents.Record(m_particles[i].pos, m_particles[i].speed);
+            KillParticle(i);
+        }
+    }
 
-    m_particleRenderCount = 0;
+    Particle* particles = m_particles.data();
 
-    // Iterate through the particles.
-    for (int i = 0; i < m_maxParticles; i++) {
-        Particle& p = m_particles[i];
+    // Position-based dynamics derives linked particles' velocities from their motion this step.
+    m_constraintSolver.SavePositions(particles);
+
+    // Mesh colliders sweep each particle from where it starts this step, wherever solvers, colliders
+    // and constraints later move it.
+    if (!m_meshColliders.empty()) {
+        m_previousPositions.resize(m_aliveCount);
+        for (int i = 0; i < m_aliveCount; i++) {
+            m_previousPositions[i] = particles[i].pos;
+        }
+    }
+
+    // Apply forces to the whole live span, then integrate positions.
+    if (m_simulationMode == SimulationMode::NBody) {
+        // Particles attract each other instead of falling along the gravity vector.
+        m_barnesHutTree.ApplyGravity(particles, m_aliveCount, deltaTime);
+    } else {
+        ApplyGravity(particles, m_aliveCount, m_gravity * 0.5f, deltaTime);
+    }
+    ApplyAffectors(m_affectors, particles, m_aliveCount, deltaTime);
+    switch (m_simulationMode) {
+        case SimulationMode::SPH:
+            // The fluid solver adds pressure and viscosity and integrates in substeps.
+            m_sphSolver.Step(particles, m_aliveCount, m_spatialGrid, deltaTime);
+            break;
+        case SimulationMode::Boids:
+            // Flocking steers velocities, then particles integrate like ballistic ones.
+            m_boidsSolver.Steer(particles, m_aliveCount, m_spatialGrid, deltaTime);
+            for (int i = 0; i < m_aliveCount; i++) {
+                particles[i].pos += particles[i].speed * deltaTime;
+            }
+            break;
+        default:
+            for (int i = 0; i < m_aliveCount; i++) {
+                particles[i].pos += particles[i].speed * deltaTime;
+            }
+            break;
+    }
+
+    // Pull linked particles back onto their distance constraints.
+    m_constraintSolver.Solve(particles, deltaTime);
+
+    // Resolve collisions, then retire particles that hit a kill-on-contact collider. Linked particles
+    // are never retired, so they pass through kill-on-contact colliders.
+    int killedParticles = ApplyColliders(m_colliders, particles, m_aliveCount, m_linkedCount);
+    for (const MeshCollider* meshCollider : m_meshColliders) {
+        int first = meshCollider->GetSettings().killOnContact ? m_linkedCount : 0;
+        killedParticles += meshCollider->Collide(particles + first, m_previousPositions.data() + first, m_aliveCount - first);
+    }
+    for (const SDFCollider* sdfCollider : m_sdfColliders) {
+        int first = sdfCollider->GetSettings().killOnContact ? m_linkedCount : 0;
+        killedParticles += sdfCollider->Collide(particles + first, m_aliveCount - first);
+    }
 
-        // Check if the particle is alive.
-        if (p.life > 0.0f) {
-            // Update particle life.
-            p.life -= m_deltaTime;
-
-            // If particle is alive, update its attributes and check frustum culling.
-            if (p.life > 0.0f) {
-                // Frustum culling on or off depending on boolean value passed in.
-                bool isVisible = !frustumCulling || ParticleFrustumCheck(p.pos);
-                if (isVisible) {
-                    p.speed += m_gravity * m_deltaTime * 0.5f;
-                    p.pos += p.speed * m_deltaTime;
-                    // Used for sorting the particles by their distance to the camera.
-                    p.cameraDistance = glm::length(p.pos - cameraPosition);
-
-                    // Store particle position data for pushing into the GPU.
-                    gpuParticleData[4 * m_particleRenderCount + 0] = p.pos.x;
-                    gpuParticleData[4 * m_particleRenderCount + 1] = p.pos.y;
-                    gpuParticleData[4 * m_particleRenderCount + 2] = p.pos.z;
-                    gpuParticleData[4 * m_particleRenderCount + 3] = p.size;
-
-                    // Store particle color data for pushing into the GPU.
-                    gpuParticleColorData[4 * m_particleRenderCount + 0] = p.r;
-                    gpuParticleColorData[4 * m_particleRenderCount + 1] = p.g;
-                    gpuParticleColorData[4 * m_particleRenderCount + 2] = p.b;
-                    gpuParticleColorData[4 * m_particleRenderCount + 3] = p.a;
-
-                    m_particleRenderCount++;
-                } else {
-                    // If the particle is not visible it is sent to the back of the sorted array.
-                    p.cameraDistance = -1.0f;
-                }
+    // Gather the impacts flagged by the colliders in one pass. Resting contacts are too slow to count.
+    // Flags are cleared even when nothing records them, so a later subscriber never sees old impacts.
+    ParticleEventBuffer& collisionEvents = m_events[(int)ParticleEventType::Collision];
+    bool recordCollisions = collisionEvents.GetCapacity() > 0;
+    for (int i = 0; i < m_aliveCount; i++) {
+        if (particles[i].collided) {
+            particles[i].collided = false;
+            if (recordCollisions && glm::dot(particles[i].speed, particles[i].speed) >= COLLISION_EVENT_MIN_SPEED * COLLISION_EVENT_MIN_SPEED) {
+                collisionEvents.Record(particles[i].pos, particles[i].speed);
+            }
+        }
+    }
+
+    if (killedParticles > 0) {
+        for (int i = m_linkedCount; i < m_aliveCount; ) {
+            if (m_particles[i].life > 0.0f) {
+                i++;
             } else {
-                // If the particle is dead it is sent to the back of the sorted array.
-                p.cameraDistance = -1.0f;
+                deathEvents.Record(m_particles[i].pos, m_particles[i].speed);
+                KillParticle(i);
             }
         }
     }
 
-    // Sort particles from furthest to closest to the camera.
-    SortParticles();
+    // Record this update's positions in the trails.
+    AdvanceTrails(deltaTime);
 
-    // Update GPU buffers with new position and color data.
-    glBindBuffer(GL_ARRAY_BUFFER, m_positionBuffer);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, m_particleRenderCount * 4 * sizeof(float), gpuParticleData.data());
+    // Sort particles from furthest to closest to the camera before packing them in draw order.
+    if (sortParticles) {
+        for (int i = m_linkedCount; i < m_aliveCount; i++) {
+            particles[i].cameraDistance = glm::length(particles[i].pos - cameraPosition);
+        }
+        SortParticles();
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_colorBuffer);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, m_particleRenderCount * 4 * sizeof(unsigned char), gpuParticleColorData.data());
-}
+    // Bin the live particles for neighbor queries once they are in their final slots. The solvers
+    // rebuild the grid with their own radius during the step, so this must come last.
+    if (m_neighborRadius > 0.0f) {
+        m_spatialGrid.Build(particles, m_aliveCount, m_neighborRadius);
+    }
+
+    m_particleRenderCount = 0;
+    bool hasLifetimeCurves = HasLifetimeCurves();
+
+    // Pack the visible particles for the GPU.
+    for (int i = 0; i < m_aliveCount; i++) {
+        const Particle& p = particles[i];
+
+        // Frustum culling on or off depending on boolean value passed in.
+        if (frustumCulling && !ParticleFrustumCheck(p.pos)) {
+            continue;
+        }
+
+        // Store particle position data for pushing into the GPU.
+        gpuParticleData[4 * m_particleRenderCount + 0] = p.pos.x;
+        gpuParticleData[4 * m_particleRenderCount + 1] = p.pos.y;
+        gpuParticleData[4 * m_particleRenderCount + 2] = p.pos.z;
+        gpuParticleData[4 * m_particleRenderCount + 3] = p.size;
+
+        // Store particle color data for pushing into the GPU.
+        gpuParticleColorData[4 * m_particleRenderCount + 0] = p.r;
+        gpuParticleColorData[4 * m_particleRenderCount + 1] = p.g;
+        gpuParticleColorData[4 * m_particleRenderCount + 2] = p.b;
+        gpuParticleColorData[4 * m_particleRenderCount + 3] = p.a;
+
+        // Colors and sizes follow the lifetime curves on the GPU, which only needs the particle's age.
+        if (hasLifetimeCurves) {
+            gpuParticleAgeData[m_particleRenderCount] = p.lifetime > 0.0f ? 1.0f - p.life / p.lifetime : 0.0f;
+        }
+
+        // Unroll the particle's trail ring oldest first.
+        if (m_trailLength >= 2) {
+            glm::vec4* trail = gpuTrailData + (size_t)m_particleRenderCount * m_trailLength;
+            if (p.trail >= 0) {
+                const glm::vec4* ring = &m_trailPoints[(size_t)p.trail * m_trailLength];
+                int oldest = m_trailHead + 1;
+                std::copy(ring + oldest, ring + m_trailLength, trail);
+                std::copy(ring, ring + oldest, trail + (m_trailLength - oldest));
+            } else {
+                std::fill(trail, trail + m_trailLength, glm::vec4(p.pos, 1.0f));
+            }
+        }
 
+        m_particleRenderCount++;
+    }
+
+    return m_particleRenderCount;
+}
 
 /**
- * Render particles.
+ * Sorts particles in order of furthest to closest. Linked particles keep their slots because
+ * constraints refer to them by index.
  */
-void ParticleEmitter::RenderParticles() {
-    // Clear the color and depth buffers to prepare for a new frame.
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glEnable(GL_DEPTH_TEST);
-	glDepthFunc(GL_LESS);
-
-    // Enables blending for transparent objects based on alpha value.
-    glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Send model matrix uniform to shader.
-    glm::mat4 model = GetModelMatrix();
-    GLint u_ModelMatrixLocation = glGetUniformLocation(m_shaderProgram, "u_ModelMatrix");
-    glUniformMatrix4fv(u_ModelMatrixLocation, 1, GL_FALSE, &model[0][0]);
-
-    // Send view matrix to shader.
-    GLint u_ViewLocation = glGetUniformLocation(m_shaderProgram, "u_ViewMatrix");
-    glm::mat4 viewMatrix = g.gCamera.GetViewMatrix();
-    glUniformMatrix4fv(u_ViewLocation, 1, GL_FALSE, &viewMatrix[0][0]);
-
-    // Send projection matrix to shader.
-    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)g.gWindowWidth / (float)g.gWindowHeight, 0.1f, 50.0f);
-    GLint u_ProjectionLocation = glGetUniformLocation(m_shaderProgram, "u_ProjectionMatrix");
-    glUniformMatrix4fv(u_ProjectionLocation, 1, GL_FALSE, &projection[0][0]);
-
-    // Use shader program.
-    glUseProgram(m_shaderProgram);
-
-    // Bind VAO.
-    glBindVertexArray(m_VAO);
-
-    // Set attribute divisors which allow for instancing.
-    glVertexAttribDivisor(0, 0); // Quad vertices - same per instance.
-    glVertexAttribDivisor(1, 1); // Particle positions - advance once per instance.
-    glVertexAttribDivisor(2, 1); // Particle colors - advance once per instance.
-
-    // Draw instanced quads.
-    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, m_particleRenderCount);
-
-    // Unbind VAO.
-    glBindVertexArray(0);
+void ParticleEmitter::SortParticles(){
+	std::sort(m_particles.begin() + m_linkedCount, m_particles.begin() + m_aliveCount);
 }
 
 /**
- * Sorts particles in order of furthest to closest.
+ * Creates a chain of particles linked by distance constraints. Linked particles live in the
+ * first slots of the particle array, never age, and are simulated with everything else before
+ * the constraints pull them back together.
+ * 
+ * @param start - the first end of the rope, in emitter space.
+ * @param end - the other end of the rope, in emitter space.
+ * @param segments - the number of links; the rope has segments + 1 particles.
+ * @param pinStart - whether the first particle is fixed in place.
+ * @param pinEnd - whether the last particle is fixed in place.
+ * @return - the index of the rope's first particle, or -1 if the emitter has no room.
  */
-void ParticleEmitter::SortParticles(){
-	std::sort(&m_particles[0], &m_particles[m_maxParticles]);
+int ParticleEmitter::AddRope(const glm::vec3& start, const glm::vec3& end, int segments, bool pinStart, bool pinEnd) {
+    int numParticles = segments + 1;
+    if (segments < 1 || m_linkedCount + numParticles > m_maxParticles) {
+        return -1;
+    }
+
+    // Make room right after the existing linked particles by moving free particles out of the way.
+    int first = m_linkedCount;
+    int numToMove = std::max(0, std::min(numParticles, m_aliveCount - first));
+    int destination = std::max(m_aliveCount, first + numParticles);
+    int available = m_maxParticles - destination;
+    if (numToMove > available) {
+        // Drop the particles that no longer fit.
+        numToMove = available;
+    }
+    for (int i = 0; i < numToMove; i++) {
+        m_particles[destination + i] = m_particles[first + i];
+    }
+    // Particles that no longer fit give their trails back before their slots are reused.
+    for (int i = numToMove; i < std::min(numParticles, m_aliveCount - first); i++) {
+        ReleaseTrail(m_particles[first + i]);
+    }
+    m_aliveCount = numToMove > 0 ? destination + numToMove : std::max(m_aliveCount, first + numParticles);
+
+    float restLength = glm::length(end - start) / segments;
+    for (int i = 0; i < numParticles; i++) {
+        Particle& p = m_particles[first + i];
+        p.pos = glm::mix(start, end, (float)i / segments);
+        p.speed = glm::vec3(0.0f);
+        p.life = 1.0f;
+        p.cameraDistance = -1.0f;
+        p.r = p.g = p.b = 255;
+        p.a = 255;
+        p.size = 0.15f;
+        p.lifetime = 1.0f;
+        p.trail = -1;
+
+        bool pinned = (i == 0 && pinStart) || (i == segments && pinEnd);
+        m_constraintSolver.AddParticle(pinned ? 0.0f : 1.0f);
+        if (i > 0) {
+            m_constraintSolver.AddConstraint(first + i - 1, first + i, restLength);
+        }
+    }
+    m_linkedCount += numParticles;
+
+    return first;
 }
 
 /**
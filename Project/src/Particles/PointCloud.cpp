@@ -0,0 +1,297 @@
+// PointCloud.cpp - Source file for memory-mapped point clouds used as particle spawn positions.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "../include/Particles/PointCloud.hpp"
+
+// PLY headers are short; a file without end_header in this many bytes is not a PLY file.
+static const size_t MAX_PLY_HEADER_SIZE = 64 * 1024;
+
+struct PointCloudFileHeader {
+    char magic[4];
+    uint32_t flags;
+    uint64_t numPoints;
+};
+
+static const uint32_t POINT_CLOUD_HAS_COLORS = 1;
+
+/**
+ * Maps a point cloud, choosing the layout from the file's first bytes.
+ */
+bool PointCloud::Load(const std::string& fileName, const glm::mat4& transform) {
+    m_numPoints = 0;
+    m_hasColors = false;
+    m_x = m_y = m_z = Property();
+    m_red = m_green = m_blue = m_alpha = Property();
+    m_transform = transform;
+    if (!m_file.Open(fileName)) {
+        return false;
+    }
+
+    bool loaded = false;
+    if (m_file.GetSize() >= 4 && std::memcmp(m_file.GetData(), "ply", 3) == 0) {
+        loaded = LoadPLY(fileName);
+    } else if (m_file.GetSize() >= 4 && std::memcmp(m_file.GetData(), "PCL1", 4) == 0) {
+        loaded = LoadFlat(fileName);
+    } else {
+        std::cout << "Point cloud " << fileName << " is neither PLY nor PCL1" << std::endl;
+    }
+
+    if (!loaded) {
+        m_numPoints = 0;
+        m_file.Close();
+    }
+    return loaded;
+}
+
+/**
+ * Points the properties at the position and color arrays of a flat file.
+ */
+bool PointCloud::LoadFlat(const std::string& fileName) {
+    PointCloudFileHeader header;
+    if (m_file.GetSize() < sizeof(header)) {
+        std::cout << "Point cloud " << fileName << " is too small for its header" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, m_file.GetData(), sizeof(header));
+
+    bool hasColors = (header.flags & POINT_CLOUD_HAS_COLORS) != 0;
+    size_t pointSize = 3 * sizeof(float) + (hasColors ? 4 : 0);
+    if (header.numPoints > (m_file.GetSize() - sizeof(header)) / pointSize) {
+        std::cout << "Point cloud " << fileName << " is truncated" << std::endl;
+        return false;
+    }
+
+    const unsigned char* positions = m_file.GetData() + sizeof(header);
+    m_x = { positions, 3 * sizeof(float), PropertyType::Float32 };
+    m_y = { positions + sizeof(float), 3 * sizeof(float), PropertyType::Float32 };
+    m_z = { positions + 2 * sizeof(float), 3 * sizeof(float), PropertyType::Float32 };
+
+    if (hasColors) {
+        const unsigned char* colors = positions + header.numPoints * 3 * sizeof(float);
+        m_red = { colors, 4, PropertyType::UInt8 };
+        m_green = { colors + 1, 4, PropertyType::UInt8 };
+        m_blue = { colors + 2, 4, PropertyType::UInt8 };
+        m_alpha = { colors + 3, 4, PropertyType::UInt8 };
+    }
+
+    m_numPoints = header.numPoints;
+    m_hasColors = hasColors;
+    return true;
+}
+
+/**
+ * Returns the size of a PLY scalar type, or 0 if the name is not one.
+ */
+static size_t GetPLYTypeSize(const std::string& name) {
+    if (name == "char" || name == "int8" || name == "uchar" || name == "uint8") return 1;
+    if (name == "short" || name == "int16" || name == "ushort" || name == "uint16") return 2;
+    if (name == "int" || name == "int32" || name == "uint" || name == "uint32" || name == "float" || name == "float32") return 4;
+    if (name == "double" || name == "float64") return 8;
+    return 0;
+}
+
+/**
+ * Reads the header of a binary little endian PLY file and locates the vertex properties inside
+ * the vertex records.
+ */
+bool PointCloud::LoadPLY(const std::string& fileName) {
+    const char* text = reinterpret_cast<const char*>(m_file.GetData());
+    size_t searchSize = std::min(m_file.GetSize(), MAX_PLY_HEADER_SIZE);
+    const char* marker = "end_header";
+    const char* end = std::search(text, text + searchSize, marker, marker + std::strlen(marker));
+    const char* dataStart = std::find(end, text + searchSize, '\n');
+    if (end == text + searchSize || dataStart == text + searchSize) {
+        std::cout << "Point cloud " << fileName << " has no end_header" << std::endl;
+        return false;
+    }
+    dataStart++;
+
+    struct PLYProperty {
+        std::string name;
+        std::string type;
+        size_t offset;
+    };
+    struct PLYElement {
+        std::string name;
+        size_t count;
+        size_t size;
+        bool hasLists;
+        std::vector<PLYProperty> properties;
+    };
+    std::vector<PLYElement> elements;
+
+    std::istringstream header(std::string(text, end));
+    std::string line;
+    bool binaryLittleEndian = false;
+    while (std::getline(header, line)) {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+
+        if (keyword == "format") {
+            std::string format;
+            stream >> format;
+            binaryLittleEndian = format == "binary_little_endian";
+        } else if (keyword == "element") {
+            PLYElement element;
+            stream >> element.name >> element.count;
+            element.size = 0;
+            element.hasLists = false;
+            elements.push_back(element);
+        } else if (keyword == "property" && !elements.empty()) {
+            PLYElement& element = elements.back();
+            PLYProperty property;
+            stream >> property.type;
+            if (property.type == "list") {
+                element.hasLists = true;
+                continue;
+            }
+            // Every element's record size must be known to find the vertices, so reject unknown types here.
+            size_t typeSize = GetPLYTypeSize(property.type);
+            if (typeSize == 0) {
+                std::cout << "Point cloud " << fileName << " has a property of unknown type " << property.type << std::endl;
+                return false;
+            }
+            stream >> property.name;
+            property.offset = element.size;
+            element.size += typeSize;
+            element.properties.push_back(property);
+        }
+    }
+
+    if (!binaryLittleEndian) {
+        std::cout << "Point cloud " << fileName << " is not binary little endian PLY" << std::endl;
+        return false;
+    }
+
+    // Skip the elements stored before the vertices; their records must have a fixed size to do so.
+    size_t offset = dataStart - text;
+    const PLYElement* vertices = nullptr;
+    for (const PLYElement& element : elements) {
+        if (element.hasLists) {
+            std::cout << "Point cloud " << fileName << " has variable-size records before its vertices" << std::endl;
+            return false;
+        }
+        if (element.name == "vertex") {
+            vertices = &element;
+            break;
+        }
+        // Check the element fits in the rest of the file before advancing, so the offset cannot overflow.
+        if (element.size > 0 && element.count > (m_file.GetSize() - offset) / element.size) {
+            std::cout << "Point cloud " << fileName << " is truncated" << std::endl;
+            return false;
+        }
+        offset += element.count * element.size;
+    }
+    if (vertices == nullptr || vertices->size == 0 || offset > m_file.GetSize() ||
+        vertices->count > (m_file.GetSize() - offset) / vertices->size) {
+        std::cout << "Point cloud " << fileName << " has no vertices or is truncated" << std::endl;
+        return false;
+    }
+
+    const unsigned char* records = m_file.GetData() + offset;
+    for (const PLYProperty& plyProperty : vertices->properties) {
+        Property property;
+        property.base = records + plyProperty.offset;
+        property.stride = vertices->size;
+
+        const std::string& type = plyProperty.type;
+        if (type == "char" || type == "int8") property.type = PropertyType::Int8;
+        else if (type == "uchar" || type == "uint8") property.type = PropertyType::UInt8;
+        else if (type == "short" || type == "int16") property.type = PropertyType::Int16;
+        else if (type == "ushort" || type == "uint16") property.type = PropertyType::UInt16;
+        else if (type == "int" || type == "int32") property.type = PropertyType::Int32;
+        else if (type == "uint" || type == "uint32") property.type = PropertyType::UInt32;
+        else if (type == "float" || type == "float32") property.type = PropertyType::Float32;
+        else if (type == "double" || type == "float64") property.type = PropertyType::Float64;
+        else {
+            std::cout << "Point cloud " << fileName << " has a property of unknown type " << type << std::endl;
+            return false;
+        }
+
+        const std::string& name = plyProperty.name;
+        if (name == "x") m_x = property;
+        else if (name == "y") m_y = property;
+        else if (name == "z") m_z = property;
+        else if (name == "red" || name == "r") m_red = property;
+        else if (name == "green" || name == "g") m_green = property;
+        else if (name == "blue" || name == "b") m_blue = property;
+        else if (name == "alpha" || name == "a") m_alpha = property;
+    }
+
+    if (!m_x.base || !m_y.base || !m_z.base) {
+        std::cout << "Point cloud " << fileName << " has no x, y and z vertex properties" << std::endl;
+        return false;
+    }
+
+    m_numPoints = vertices->count;
+    m_hasColors = m_red.base && m_green.base && m_blue.base;
+    return true;
+}
+
+/**
+ * Reads one scalar out of the mapping. Values are copied out byte-wise because PLY records are
+ * packed and need not be aligned.
+ */
+float PointCloud::ReadProperty(const Property& property, size_t index) {
+    const unsigned char* value = property.base + index * property.stride;
+    switch (property.type) {
+        case PropertyType::Int8: { int8_t v; std::memcpy(&v, value, sizeof(v)); return v; }
+        case PropertyType::UInt8: return *value;
+        case PropertyType::Int16: { int16_t v; std::memcpy(&v, value, sizeof(v)); return v; }
+        case PropertyType::UInt16: { uint16_t v; std::memcpy(&v, value, sizeof(v)); return v; }
+        case PropertyType::Int32: { int32_t v; std::memcpy(&v, value, sizeof(v)); return (float)v; }
+        case PropertyType::UInt32: { uint32_t v; std::memcpy(&v, value, sizeof(v)); return (float)v; }
+        case PropertyType::Float32: { float v; std::memcpy(&v, value, sizeof(v)); return v; }
+        case PropertyType::Float64: { double v; std::memcpy(&v, value, sizeof(v)); return (float)v; }
+    }
+    return 0.0f;
+}
+
+/**
+ * Reads one color channel as a byte. Floating point channels are in [0, 1] and 16-bit channels
+ * use their full range.
+ */
+unsigned char PointCloud::ReadColor(const Property& property, size_t index) {
+    float value = ReadProperty(property, index);
+    switch (property.type) {
+        case PropertyType::Float32:
+        case PropertyType::Float64:
+            value *= 255.0f;
+            break;
+        case PropertyType::UInt16:
+            value /= 257.0f;
+            break;
+        default:
+            break;
+    }
+    return (unsigned char)std::min(std::max(value + 0.5f, 0.0f), 255.0f);
+}
+
+/**
+ * Decodes a point's position, in emitter space.
+ */
+glm::vec3 PointCloud::GetPosition(size_t index) const {
+    glm::vec3 position(ReadProperty(m_x, index), ReadProperty(m_y, index), ReadProperty(m_z, index));
+    return glm::vec3(m_transform * glm::vec4(position, 1.0f));
+}
+
+/**
+ * Decodes a point's color as rgba bytes.
+ */
+void PointCloud::GetColor(size_t index, unsigned char rgba[4]) const {
+    if (!m_hasColors) {
+        rgba[0] = rgba[1] = rgba[2] = rgba[3] = 255;
+        return;
+    }
+    rgba[0] = ReadColor(m_red, index);
+    rgba[1] = ReadColor(m_green, index);
+    rgba[2] = ReadColor(m_blue, index);
+    rgba[3] = m_alpha.base ? ReadColor(m_alpha, index) : 255;
+}
@@ -0,0 +1,138 @@
+// WeightedBlendedOIT.cpp - Source file for the weighted blended order-independent transparency render target.
+
+#include "../include/Particles/WeightedBlendedOIT.hpp"
+
+/**
+ * Constructor - creates the composite shader program and the accumulation targets.
+ */
+WeightedBlendedOIT::WeightedBlendedOIT(int width, int height) : m_width(width), m_height(height) {
+    m_compositeShader = new Shader();
+    std::string vertexShader = m_compositeShader->LoadShaderAsString("./shaders/Fullscreen.vert");
+    std::string fragmentShader = m_compositeShader->LoadShaderAsString("./shaders/OITComposite.frag");
+    m_compositeShader->CreateShaderProgram(vertexShader, fragmentShader);
+    m_compositeProgram = m_compositeShader->GetShaderID();
+
+    // The fullscreen triangle is generated from gl_VertexID, but core profile needs a VAO bound.
+    glGenVertexArrays(1, &m_fullscreenVAO);
+
+    CreateTargets();
+}
+
+/**
+ * Destructor - Delete the targets, VAO, and composite program.
+ */
+WeightedBlendedOIT::~WeightedBlendedOIT() {
+    DeleteTargets();
+    if (m_fullscreenVAO) glDeleteVertexArrays(1, &m_fullscreenVAO);
+    delete m_compositeShader;
+}
+
+/**
+ * Creates the accumulation (RGBA16F) and revealage (R8) textures and a depth buffer.
+ */
+void WeightedBlendedOIT::CreateTargets() {
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    // Accumulation needs a float format: weighted colors sum well above 1.
+    glGenTextures(1, &m_accumTexture);
+    glBindTexture(GL_TEXTURE_2D, m_accumTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, m_width, m_height, 0, GL_RGBA, GL_HALF_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_accumTexture, 0);
+
+    // Revealage is a product of (1 - alpha) terms, so 8 bits is enough.
+    glGenTextures(1, &m_revealageTexture);
+    glBindTexture(GL_TEXTURE_2D, m_revealageTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_width, m_height, 0, GL_RED, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_revealageTexture, 0);
+
+    glGenRenderbuffers(1, &m_depthRenderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthRenderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, m_width, m_height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_depthRenderbuffer);
+
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "Error: OIT framebuffer is incomplete" << std::endl;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+/**
+ * Deletes the framebuffer and its attachments.
+ */
+void WeightedBlendedOIT::DeleteTargets() {
+    if (m_framebuffer) glDeleteFramebuffers(1, &m_framebuffer);
+    if (m_accumTexture) glDeleteTextures(1, &m_accumTexture);
+    if (m_revealageTexture) glDeleteTextures(1, &m_revealageTexture);
+    if (m_depthRenderbuffer) glDeleteRenderbuffers(1, &m_depthRenderbuffer);
+    m_framebuffer = m_accumTexture = m_revealageTexture = m_depthRenderbuffer = 0;
+}
+
+/**
+ * Recreates the targets if the window size changed.
+ */
+void WeightedBlendedOIT::Resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    m_width = width;
+    m_height = height;
+    DeleteTargets();
+    CreateTargets();
+}
+
+/**
+ * Binds and clears the OIT targets and sets the accumulation blend state.
+ */
+void WeightedBlendedOIT::Begin() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    // Accumulation starts at zero and revealage at one (fully revealed background).
+    const GLfloat clearAccum[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    const GLfloat clearRevealage[] = { 1.0f, 0.0f, 0.0f, 0.0f };
+    glClearBufferfv(GL_COLOR, 0, clearAccum);
+    glClearBufferfv(GL_COLOR, 1, clearRevealage);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    // Transparent surfaces are depth tested but never occlude each other.
+    glEnable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+
+    // Sum weighted colors, multiply revealage by (1 - alpha).
+    glEnable(GL_BLEND);
+    glBlendFunci(0, GL_ONE, GL_ONE);
+    glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+}
+
+/**
+ * Rebinds the default framebuffer and composites the accumulated transparency over it.
+ */
+void WeightedBlendedOIT::End() {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_DEPTH_TEST);
+
+    // Output alpha is (1 - revealage), so this blends average * coverage over the background.
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glUseProgram(m_compositeProgram);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_accumTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, m_revealageTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(m_fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);
+}
@@ -0,0 +1,303 @@
+// BarnesHutTree.cpp - Source file for the Barnes-Hut octree used for n-body gravity.
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "../include/Physics/BarnesHutTree.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+// Levels split serially before subtrees are handed to worker threads (up to 8^2 = 64 tasks).
+static const int PARALLEL_SPLIT_DEPTH = 2;
+// Past this depth, coincident particles share a leaf instead of splitting forever.
+static const int MAX_DEPTH = 24;
+static const int NBODY_GRAIN_SIZE = 512;
+
+/**
+ * Reorders m_order[begin, end) by octant around center with three levels of partitions (x, then y,
+ * then z). Octant k (x is bit 2, y is bit 1, z is bit 0) ends up in [octantEnds[k - 1], octantEnds[k]),
+ * where octantEnds[-1] is begin.
+ */
+void BarnesHutTree::PartitionOctants(int begin, int end, const glm::vec3& center, int octantEnds[8]) {
+    int* first = m_order.data() + begin;
+    int* last = m_order.data() + end;
+    auto below = [this, &center](int axis) {
+        return [this, axis, &center](int i) { return m_positions[i][axis] < center[axis]; };
+    };
+
+    int* splitX = std::partition(first, last, below(0));
+    int* splitY[2] = { std::partition(first, splitX, below(1)), std::partition(splitX, last, below(1)) };
+    int* quarters[5] = { first, splitY[0], splitX, splitY[1], last };
+
+    for (int q = 0; q < 4; q++) {
+        int* splitZ = std::partition(quarters[q], quarters[q + 1], below(2));
+        octantEnds[q * 2] = (int)(splitZ - m_order.data());
+        octantEnds[q * 2 + 1] = (int)(quarters[q + 1] - m_order.data());
+    }
+}
+
+/**
+ * Returns the center of the child cube for octant k in memory order (z fastest, then y, then x).
+ */
+static glm::vec3 ChildCenter(const glm::vec3& center, float halfSize, int k) {
+    float quarter = halfSize * 0.5f;
+    return center + glm::vec3((k & 4) ? quarter : -quarter,
+                              (k & 2) ? quarter : -quarter,
+                              (k & 1) ? quarter : -quarter);
+}
+
+/**
+ * Recursively builds a subtree into nodes. nodes[nodeIndex] must already exist.
+ */
+void BarnesHutTree::BuildNode(std::vector<Node>& nodes, int nodeIndex, int begin, int end,
+                              const glm::vec3& center, float halfSize, int depth) {
+    Node node;
+    node.center = center;
+    node.halfSize = halfSize;
+    node.firstChild = -1;
+    node.childCount = 0;
+    node.firstParticle = begin;
+    node.particleCount = end - begin;
+
+    if (end - begin <= m_settings.leafSize || depth >= MAX_DEPTH) {
+        glm::vec3 sum(0.0f);
+        for (int i = begin; i < end; i++) {
+            sum += m_positions[m_order[i]];
+        }
+        node.mass = (end - begin) * m_settings.particleMass;
+        node.centerOfMass = sum / (float)std::max(1, end - begin);
+        nodes[nodeIndex] = node;
+        return;
+    }
+
+    int octantEnds[8];
+    PartitionOctants(begin, end, center, octantEnds);
+
+    // Allocate the non-empty children contiguously.
+    int childBegin[8];
+    int childEnd[8];
+    int numChildren = 0;
+    int start = begin;
+    for (int k = 0; k < 8; k++) {
+        childBegin[k] = start;
+        childEnd[k] = octantEnds[k];
+        if (octantEnds[k] > start) {
+            numChildren++;
+        }
+        start = octantEnds[k];
+    }
+    node.firstChild = nodes.size();
+    node.childCount = numChildren;
+    nodes.resize(nodes.size() + numChildren);
+
+    int child = node.firstChild;
+    glm::vec3 weightedSum(0.0f);
+    float mass = 0.0f;
+    for (int k = 0; k < 8; k++) {
+        if (childEnd[k] == childBegin[k]) {
+            continue;
+        }
+        BuildNode(nodes, child, childBegin[k], childEnd[k], ChildCenter(center, halfSize, k), halfSize * 0.5f, depth + 1);
+        weightedSum += nodes[child].centerOfMass * nodes[child].mass;
+        mass += nodes[child].mass;
+        child++;
+    }
+    node.mass = mass;
+    node.centerOfMass = weightedSum / mass;
+    nodes[nodeIndex] = node;
+}
+
+/**
+ * Splits the top levels of the tree serially and records the subtrees below them as tasks.
+ */
+void BarnesHutTree::BuildTop(int nodeIndex, int begin, int end, const glm::vec3& center, float halfSize, int depth) {
+    m_topNodes.push_back(nodeIndex);
+
+    if (depth == PARALLEL_SPLIT_DEPTH || end - begin <= m_settings.leafSize) {
+        m_topNodeIsTask.push_back(true);
+        BuildTask task;
+        task.nodeIndex = nodeIndex;
+        task.begin = begin;
+        task.end = end;
+        task.center = center;
+        task.halfSize = halfSize;
+        m_tasks.push_back(std::move(task));
+        return;
+    }
+    m_topNodeIsTask.push_back(false);
+
+    int octantEnds[8];
+    PartitionOctants(begin, end, center, octantEnds);
+
+    int numChildren = 0;
+    int start = begin;
+    for (int k = 0; k < 8; k++) {
+        if (octantEnds[k] > start) {
+            numChildren++;
+        }
+        start = octantEnds[k];
+    }
+
+    Node& node = m_nodes[nodeIndex];
+    node.center = center;
+    node.halfSize = halfSize;
+    node.firstChild = m_nodes.size();
+    node.childCount = numChildren;
+    node.firstParticle = begin;
+    node.particleCount = end - begin;
+    int firstChild = node.firstChild;
+    m_nodes.resize(m_nodes.size() + numChildren);
+
+    int child = firstChild;
+    start = begin;
+    for (int k = 0; k < 8; k++) {
+        if (octantEnds[k] > start) {
+            BuildTop(child, start, octantEnds[k], ChildCenter(center, halfSize, k), halfSize * 0.5f, depth + 1);
+            child++;
+        }
+        start = octantEnds[k];
+    }
+}
+
+/**
+ * Rebuilds the octree from the particle positions.
+ */
+void BarnesHutTree::Build(const Particle* particles, int count) {
+    m_positions.resize(count);
+    m_order.resize(count);
+
+    // Bounding box, reduced per chunk and merged under a lock.
+    glm::vec3 boundsMin(INFINITY);
+    glm::vec3 boundsMax(-INFINITY);
+    std::mutex boundsMutex;
+    ParallelFor(count, NBODY_GRAIN_SIZE * 8, [&](int begin, int end) {
+        glm::vec3 localMin(INFINITY);
+        glm::vec3 localMax(-INFINITY);
+        for (int i = begin; i < end; i++) {
+            m_positions[i] = particles[i].pos;
+            m_order[i] = i;
+            localMin = glm::min(localMin, particles[i].pos);
+            localMax = glm::max(localMax, particles[i].pos);
+        }
+        std::lock_guard<std::mutex> lock(boundsMutex);
+        boundsMin = glm::min(boundsMin, localMin);
+        boundsMax = glm::max(boundsMax, localMax);
+    });
+
+    glm::vec3 extent = boundsMax - boundsMin;
+    float halfSize = 0.5f * std::max(extent.x, std::max(extent.y, extent.z)) + 1e-3f;
+    glm::vec3 center = 0.5f * (boundsMin + boundsMax);
+
+    m_nodes.clear();
+    m_nodes.resize(1);
+    m_tasks.clear();
+    m_topNodes.clear();
+    m_topNodeIsTask.clear();
+    BuildTop(0, 0, count, center, halfSize, 0);
+
+    // Build the subtrees in parallel. Each task owns a disjoint range of m_order and its own nodes.
+    ParallelFor(m_tasks.size(), 1, [&](int begin, int end) {
+        for (int t = begin; t < end; t++) {
+            BuildTask& task = m_tasks[t];
+            task.nodes.clear();
+            task.nodes.resize(1);
+            BuildNode(task.nodes, 0, task.begin, task.end, task.center, task.halfSize, PARALLEL_SPLIT_DEPTH);
+        }
+    });
+
+    // Join the subtrees: a task's root replaces its placeholder, the rest are appended.
+    for (BuildTask& task : m_tasks) {
+        int offset = (int)m_nodes.size() - 1;
+        for (size_t k = 1; k < task.nodes.size(); k++) {
+            Node node = task.nodes[k];
+            if (node.firstChild >= 0) {
+                node.firstChild += offset;
+            }
+            m_nodes.push_back(node);
+        }
+        Node root = task.nodes[0];
+        if (root.firstChild >= 0) {
+            root.firstChild += offset;
+        }
+        m_nodes[task.nodeIndex] = root;
+    }
+
+    // Top nodes were created parents first, so a reverse pass sees children before parents.
+    for (int k = (int)m_topNodes.size() - 1; k >= 0; k--) {
+        if (m_topNodeIsTask[k]) {
+            continue;
+        }
+        Node& node = m_nodes[m_topNodes[k]];
+        glm::vec3 weightedSum(0.0f);
+        float mass = 0.0f;
+        for (int c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+            weightedSum += m_nodes[c].centerOfMass * m_nodes[c].mass;
+            mass += m_nodes[c].mass;
+        }
+        node.mass = mass;
+        node.centerOfMass = weightedSum / mass;
+    }
+}
+
+/**
+ * Walks the tree from the root, opening nodes that are too close for their size.
+ */
+glm::vec3 BarnesHutTree::ComputeAcceleration(const glm::vec3& position, int self) const {
+    const float thetaSquared = m_settings.theta * m_settings.theta;
+    const float softeningSquared = m_settings.softening * m_settings.softening;
+
+    glm::vec3 acceleration(0.0f);
+    int stack[8 * (MAX_DEPTH + 1)];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const Node& node = m_nodes[stack[--stackSize]];
+        glm::vec3 offset = node.centerOfMass - position;
+        float distanceSquared = glm::dot(offset, offset);
+        float size = node.halfSize * 2.0f;
+
+        if (node.firstChild < 0) {
+            // Leaves are summed directly.
+            for (int k = node.firstParticle; k < node.firstParticle + node.particleCount; k++) {
+                int j = m_order[k];
+                if (j == self) {
+                    continue;
+                }
+                glm::vec3 d = m_positions[j] - position;
+                float r2 = glm::dot(d, d) + softeningSquared;
+                acceleration += d * (m_settings.particleMass / (r2 * std::sqrt(r2)));
+            }
+        } else if (size * size < thetaSquared * distanceSquared) {
+            float r2 = distanceSquared + softeningSquared;
+            acceleration += offset * (node.mass / (r2 * std::sqrt(r2)));
+        } else {
+            for (int c = node.firstChild; c < node.firstChild + node.childCount; c++) {
+                stack[stackSize++] = c;
+            }
+        }
+    }
+
+    return acceleration * m_settings.gravitationalConstant;
+}
+
+/**
+ * Rebuilds the tree and adds the gravitational acceleration of every particle on every other
+ * to the particle velocities.
+ */
+void BarnesHutTree::ApplyGravity(Particle* particles, int count, float deltaTime) {
+    if (count < 2) {
+        return;
+    }
+
+    Build(particles, count);
+
+    // Evaluate in tree order so neighboring threads walk similar paths through the tree.
+    // The tree reads its own position copy, so velocities can be written in place.
+    ParallelFor(count, NBODY_GRAIN_SIZE, [&](int begin, int end) {
+        for (int k = begin; k < end; k++) {
+            int i = m_order[k];
+            particles[i].speed += ComputeAcceleration(m_positions[i], i) * deltaTime;
+        }
+    });
+}
@@ -0,0 +1,95 @@
+// BoidsSolver.cpp - Source file for the boids flocking behavior.
+
+#include <algorithm>
+#include <cmath>
+
+#include "../include/Physics/BoidsSolver.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+static const int BOIDS_GRAIN_SIZE = 1024;
+
+/**
+ * Adds this frame's flocking steering to the particle velocities and clamps their speed.
+ */
+void BoidsSolver::Steer(Particle* particles, int count, SpatialGrid& grid, float deltaTime) {
+    if (count == 0) {
+        return;
+    }
+
+    const BoidsSettings& s = m_settings;
+    const float separationRadiusSquared = s.separationRadius * s.separationRadius;
+
+    grid.Build(particles, count, s.neighborRadius);
+    const std::vector<int>& sortedIndices = grid.GetSortedIndices();
+    const std::vector<glm::vec3>& positions = grid.GetSortedPositions();
+
+    m_velocities.resize(count);
+    m_steeredVelocities.resize(count);
+
+    ParallelFor(count, BOIDS_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            m_velocities[i] = particles[sortedIndices[i]].speed;
+        }
+    });
+
+    ParallelFor(count, BOIDS_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            const glm::vec3 position = positions[i];
+            const glm::vec3 velocity = m_velocities[i];
+            float speed = glm::length(velocity);
+            glm::vec3 heading = speed > 1e-6f ? velocity / speed : glm::vec3(0.0f, 0.0f, 1.0f);
+
+            glm::vec3 separation(0.0f);
+            glm::vec3 averageVelocity(0.0f);
+            glm::vec3 averagePosition(0.0f);
+            int numNeighbors = 0;
+
+            grid.ForEachNeighborSlot(position, s.neighborRadius, [&](uint32_t j, float r2) {
+                if (j == (uint32_t)i || r2 < 1e-12f) {
+                    return true;
+                }
+
+                // Ignore flockmates behind the boid.
+                glm::vec3 offset = positions[j] - position;
+                float distance = std::sqrt(r2);
+                if (glm::dot(heading, offset) < s.fieldOfViewCos * distance) {
+                    return true;
+                }
+
+                if (r2 < separationRadiusSquared) {
+                    separation -= offset / r2;
+                }
+                averageVelocity += m_velocities[j];
+                averagePosition += positions[j];
+                numNeighbors++;
+                return numNeighbors < s.maxNeighbors;
+            });
+
+            glm::vec3 steering = separation * s.separationWeight;
+            if (numNeighbors > 0) {
+                float inverseCount = 1.0f / numNeighbors;
+                steering += (averageVelocity * inverseCount - velocity) * s.alignmentWeight;
+                steering += (averagePosition * inverseCount - position) * s.cohesionWeight;
+            }
+
+            // Soft containment around the emitter.
+            float distanceFromCenter = glm::length(position);
+            if (distanceFromCenter > s.boundsRadius) {
+                steering -= position * ((distanceFromCenter - s.boundsRadius) / distanceFromCenter * s.boundsWeight);
+            }
+
+            glm::vec3 steered = velocity + steering * deltaTime;
+            float steeredSpeed = glm::length(steered);
+            if (steeredSpeed > 1e-6f) {
+                steered *= glm::clamp(steeredSpeed, s.minSpeed, s.maxSpeed) / steeredSpeed;
+            }
+            m_steeredVelocities[i] = steered;
+        }
+    });
+
+    ParallelFor(count, BOIDS_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            particles[sortedIndices[i]].speed = m_steeredVelocities[i];
+        }
+    });
+}
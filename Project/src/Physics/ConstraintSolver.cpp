@@ -0,0 +1,105 @@
+// ConstraintSolver.cpp - Source file for the position-based dynamics distance constraint solver.
+
+#include "../include/Physics/ConstraintSolver.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+static const int CONSTRAINT_GRAIN_SIZE = 2048;
+
+/**
+ * Records positions before integration; PBD derives velocities from the change.
+ */
+void ConstraintSolver::SavePositions(const Particle* particles) {
+    int count = GetNumParticles();
+    m_previousPositions.resize(count);
+    for (int i = 0; i < count; i++) {
+        m_previousPositions[i] = particles[i].pos;
+    }
+}
+
+/**
+ * Builds the CSR lists of constraints touching each particle.
+ */
+void ConstraintSolver::BuildAdjacency() {
+    int count = GetNumParticles();
+    m_adjacencyStart.assign(count + 1, 0);
+    for (const DistanceConstraint& c : m_constraints) {
+        m_adjacencyStart[c.a + 1]++;
+        m_adjacencyStart[c.b + 1]++;
+    }
+    for (int i = 0; i < count; i++) {
+        m_adjacencyStart[i + 1] += m_adjacencyStart[i];
+    }
+
+    m_adjacency.resize(m_adjacencyStart[count]);
+    std::vector<int> fill(m_adjacencyStart.begin(), m_adjacencyStart.end() - 1);
+    for (int c = 0; c < (int)m_constraints.size(); c++) {
+        m_adjacency[fill[m_constraints[c].a]++] = c;
+        m_adjacency[fill[m_constraints[c].b]++] = -c - 1;
+    }
+
+    m_corrections.resize(m_constraints.size());
+    m_adjacencyDirty = false;
+}
+
+/**
+ * Projects the integrated positions onto the constraints and updates velocities to match.
+ */
+void ConstraintSolver::Solve(Particle* particles, float deltaTime) {
+    int count = GetNumParticles();
+    if (count == 0 || m_constraints.empty() || deltaTime <= 0.0f) {
+        return;
+    }
+    if (m_adjacencyDirty) {
+        BuildAdjacency();
+    }
+
+    const std::vector<float>& w = m_inverseMasses;
+
+    // Pinned particles do not move, whatever forces were applied to them.
+    for (int i = 0; i < count; i++) {
+        if (w[i] == 0.0f) {
+            particles[i].pos = m_previousPositions[i];
+        }
+    }
+
+    for (int iteration = 0; iteration < m_settings.iterations; iteration++) {
+        // Each constraint computes its correction independently.
+        ParallelFor(m_constraints.size(), CONSTRAINT_GRAIN_SIZE, [&](int begin, int end) {
+            for (int c = begin; c < end; c++) {
+                const DistanceConstraint& constraint = m_constraints[c];
+                float weightSum = w[constraint.a] + w[constraint.b];
+                glm::vec3 delta = particles[constraint.a].pos - particles[constraint.b].pos;
+                float length = glm::length(delta);
+                if (weightSum == 0.0f || length < 1e-6f) {
+                    m_corrections[c] = glm::vec3(0.0f);
+                    continue;
+                }
+                m_corrections[c] = delta * (-(length - constraint.restLength) / (length * weightSum));
+            }
+        });
+
+        // Each particle averages the corrections of its constraints.
+        ParallelFor(count, CONSTRAINT_GRAIN_SIZE, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                int first = m_adjacencyStart[i];
+                int numConstraints = m_adjacencyStart[i + 1] - first;
+                if (numConstraints == 0 || w[i] == 0.0f) {
+                    continue;
+                }
+
+                glm::vec3 correction(0.0f);
+                for (int k = first; k < first + numConstraints; k++) {
+                    int entry = m_adjacency[k];
+                    correction += entry >= 0 ? m_corrections[entry] : -m_corrections[-entry - 1];
+                }
+                particles[i].pos += correction * (w[i] * m_settings.relaxation / numConstraints);
+            }
+        });
+    }
+
+    // Velocities follow the projected positions.
+    float inverseDeltaTime = 1.0f / deltaTime;
+    for (int i = 0; i < count; i++) {
+        particles[i].speed = (particles[i].pos - m_previousPositions[i]) * inverseDeltaTime;
+    }
+}
@@ -0,0 +1,130 @@
+// CurlNoise.cpp - Source file for precomputed, tileable curl-noise volumes.
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../include/Physics/CurlNoise.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+// Perlin's improved-noise gradients: the edge midpoints of a cube.
+static const glm::vec3 GRADIENTS[12] = {
+    glm::vec3(1, 1, 0), glm::vec3(-1, 1, 0), glm::vec3(1, -1, 0), glm::vec3(-1, -1, 0),
+    glm::vec3(1, 0, 1), glm::vec3(-1, 0, 1), glm::vec3(1, 0, -1), glm::vec3(-1, 0, -1),
+    glm::vec3(0, 1, 1), glm::vec3(0, -1, 1), glm::vec3(0, 1, -1), glm::vec3(0, -1, -1)
+};
+
+static uint32_t HashLattice(int x, int y, int z, uint32_t seed) {
+    uint32_t hash = seed * 0x9E3779B9u;
+    hash ^= (uint32_t)x * 0x85EBCA6Bu;
+    hash = (hash ^ (hash >> 13)) * 0xC2B2AE35u;
+    hash ^= (uint32_t)y * 0x27D4EB2Fu;
+    hash = (hash ^ (hash >> 15)) * 0x165667B1u;
+    hash ^= (uint32_t)z * 0x9E3779B1u;
+    hash = (hash ^ (hash >> 16)) * 0x85EBCA6Bu;
+    return hash ^ (hash >> 13);
+}
+
+static float Fade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+/**
+ * Gradient noise whose lattice wraps every period cells, so the noise tiles over that distance.
+ */
+static float PeriodicNoise(const glm::vec3& p, int period, uint32_t seed) {
+    int x0 = (int)std::floor(p.x), y0 = (int)std::floor(p.y), z0 = (int)std::floor(p.z);
+    glm::vec3 f = p - glm::vec3(x0, y0, z0);
+    glm::vec3 w = glm::vec3(Fade(f.x), Fade(f.y), Fade(f.z));
+
+    float corners[8];
+    for (int c = 0; c < 8; c++) {
+        int dx = c & 1, dy = (c >> 1) & 1, dz = (c >> 2) & 1;
+        int lx = ((x0 + dx) % period + period) % period;
+        int ly = ((y0 + dy) % period + period) % period;
+        int lz = ((z0 + dz) % period + period) % period;
+        const glm::vec3& gradient = GRADIENTS[HashLattice(lx, ly, lz, seed) % 12];
+        corners[c] = glm::dot(gradient, f - glm::vec3(dx, dy, dz));
+    }
+
+    float x00 = corners[0] + (corners[1] - corners[0]) * w.x;
+    float x10 = corners[2] + (corners[3] - corners[2]) * w.x;
+    float x01 = corners[4] + (corners[5] - corners[4]) * w.x;
+    float x11 = corners[6] + (corners[7] - corners[6]) * w.x;
+    float y0v = x00 + (x10 - x00) * w.y;
+    float y1v = x01 + (x11 - x01) * w.y;
+    return y0v + (y1v - y0v) * w.z;
+}
+
+/**
+ * Fills a volume with tileable, divergence-free curl noise.
+ */
+void GenerateCurlNoise(FieldVolume<glm::vec3>& volume, int resolution, float cellSize, int period, int octaves, unsigned int seed) {
+    glm::ivec3 dimensions(resolution);
+    volume.Allocate(dimensions, glm::vec3(0.0f), cellSize, true);
+
+    // The vector potential, one noise channel per component.
+    FieldVolume<glm::vec3> potential;
+    potential.Allocate(dimensions, glm::vec3(0.0f), cellSize, true);
+    ParallelFor(resolution, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < resolution; y++) {
+                for (int x = 0; x < resolution; x++) {
+                    glm::vec3 value(0.0f);
+                    float amplitude = 1.0f;
+                    int octavePeriod = period;
+                    for (int octave = 0; octave < octaves; octave++) {
+                        // Lattice coordinates; the volume spans exactly octavePeriod lattice cells.
+                        glm::vec3 p = glm::vec3(x, y, z) * ((float)octavePeriod / resolution);
+                        for (int channel = 0; channel < 3; channel++) {
+                            value[channel] += amplitude * PeriodicNoise(p, octavePeriod, seed * 3 + channel + octave * 101);
+                        }
+                        amplitude *= 0.5f;
+                        octavePeriod *= 2;
+                    }
+                    potential.At(x, y, z) = value;
+                }
+            }
+        }
+    });
+
+    // Curl by central differences, wrapping at the edges like the noise does.
+    std::vector<double> sliceEnergy(resolution, 0.0);
+    float inverseTwoCells = 0.5f / cellSize;
+    ParallelFor(resolution, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            int zm = (z + resolution - 1) % resolution, zp = (z + 1) % resolution;
+            for (int y = 0; y < resolution; y++) {
+                int ym = (y + resolution - 1) % resolution, yp = (y + 1) % resolution;
+                for (int x = 0; x < resolution; x++) {
+                    int xm = (x + resolution - 1) % resolution, xp = (x + 1) % resolution;
+                    glm::vec3 ddx = (potential.At(xp, y, z) - potential.At(xm, y, z)) * inverseTwoCells;
+                    glm::vec3 ddy = (potential.At(x, yp, z) - potential.At(x, ym, z)) * inverseTwoCells;
+                    glm::vec3 ddz = (potential.At(x, y, zp) - potential.At(x, y, zm)) * inverseTwoCells;
+                    glm::vec3 curl(ddy.z - ddz.y, ddz.x - ddx.z, ddx.y - ddy.x);
+                    volume.At(x, y, z) = curl;
+                    sliceEnergy[z] += glm::dot(curl, curl);
+                }
+            }
+        }
+    });
+
+    double energy = 0.0;
+    for (double e : sliceEnergy) {
+        energy += e;
+    }
+    float rms = (float)std::sqrt(energy / ((double)resolution * resolution * resolution));
+    if (rms <= 0.0f) {
+        return;
+    }
+    float scale = 1.0f / rms;
+    ParallelFor(resolution, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < resolution; y++) {
+                for (int x = 0; x < resolution; x++) {
+                    volume.At(x, y, z) *= scale;
+                }
+            }
+        }
+    });
+}
@@ -0,0 +1,237 @@
+// GridFluidSolver.cpp - Source file for the Eulerian grid wind and smoke solver.
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "../include/Physics/GridFluidSolver.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+/**
+ * Constructor - allocates the grid at rest with no smoke.
+ */
+GridFluidSolver::GridFluidSolver(const GridFluidSettings& settings) : m_settings(settings) {
+    const glm::ivec3& n = m_settings.resolution;
+    m_velocity.Allocate(n, m_settings.origin, m_settings.cellSize);
+    m_advectedVelocity.Allocate(n, m_settings.origin, m_settings.cellSize);
+    m_density.Allocate(n, m_settings.origin, m_settings.cellSize);
+    m_advectedDensity.Allocate(n, m_settings.origin, m_settings.cellSize);
+
+    size_t numCells = (size_t)n.x * n.y * n.z;
+    m_curl.assign(numCells, glm::vec3(0.0f));
+    m_divergence.assign(numCells, 0.0f);
+    m_pressure.assign(numCells, 0.0f);
+    m_nextPressure.assign(numCells, 0.0f);
+}
+
+/**
+ * Advances the fluid by one step.
+ */
+void GridFluidSolver::Step(float deltaTime) {
+    if (deltaTime <= 0.0f) {
+        return;
+    }
+
+    ApplySources(deltaTime);
+    ApplyVorticityConfinement(deltaTime);
+    Project();
+    AdvectVelocity(deltaTime);
+    AdvectDensity(deltaTime);
+    Project();
+}
+
+/**
+ * Injects source velocity and smoke, adds buoyancy and damps the velocity.
+ */
+void GridFluidSolver::ApplySources(float deltaTime) {
+    const glm::ivec3& n = m_settings.resolution;
+    float damping = std::exp(-m_settings.velocityDamping * deltaTime);
+    float decay = std::exp(-m_settings.densityDecay * deltaTime);
+
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3 position = m_velocity.GetSamplePosition(x, y, z);
+                    glm::vec3& velocity = m_velocity.At(x, y, z);
+                    float& density = m_density.At(x, y, z);
+
+                    for (const GridFluidSource& source : m_sources) {
+                        glm::vec3 offset = position - source.position;
+                        if (glm::dot(offset, offset) <= source.radius * source.radius) {
+                            velocity = source.velocity;
+                            density += source.density * deltaTime;
+                        }
+                    }
+
+                    density *= decay;
+                    velocity.y += m_settings.buoyancy * density * deltaTime;
+                    velocity *= damping;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Adds a force along grad|curl| x curl, which spins up existing eddies that coarse grids smear out.
+ */
+void GridFluidSolver::ApplyVorticityConfinement(float deltaTime) {
+    if (m_settings.vorticity <= 0.0f) {
+        return;
+    }
+
+    const glm::ivec3& n = m_settings.resolution;
+    float inverseTwoCells = 0.5f / m_settings.cellSize;
+
+    auto clampX = [&](int x) { return std::min(std::max(x, 0), n.x - 1); };
+    auto clampY = [&](int y) { return std::min(std::max(y, 0), n.y - 1); };
+    auto clampZ = [&](int z) { return std::min(std::max(z, 0), n.z - 1); };
+
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3 ddx = (m_velocity.At(clampX(x + 1), y, z) - m_velocity.At(clampX(x - 1), y, z)) * inverseTwoCells;
+                    glm::vec3 ddy = (m_velocity.At(x, clampY(y + 1), z) - m_velocity.At(x, clampY(y - 1), z)) * inverseTwoCells;
+                    glm::vec3 ddz = (m_velocity.At(x, y, clampZ(z + 1)) - m_velocity.At(x, y, clampZ(z - 1))) * inverseTwoCells;
+                    m_curl[Index(x, y, z)] = glm::vec3(ddy.z - ddz.y, ddz.x - ddx.z, ddx.y - ddy.x);
+                }
+            }
+        }
+    });
+
+    float scale = m_settings.vorticity * m_settings.cellSize * deltaTime;
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3 gradient(
+                        glm::length(m_curl[Index(clampX(x + 1), y, z)]) - glm::length(m_curl[Index(clampX(x - 1), y, z)]),
+                        glm::length(m_curl[Index(x, clampY(y + 1), z)]) - glm::length(m_curl[Index(x, clampY(y - 1), z)]),
+                        glm::length(m_curl[Index(x, y, clampZ(z + 1))]) - glm::length(m_curl[Index(x, y, clampZ(z - 1))]));
+                    float length = glm::length(gradient);
+                    if (length < 1e-6f) {
+                        continue;
+                    }
+                    m_velocity.At(x, y, z) += glm::cross(gradient / length, m_curl[Index(x, y, z)]) * scale;
+                }
+            }
+        }
+    });
+}
+
+/**
+ * Semi-Lagrangian advection: each cell takes the velocity found by tracing backward along the flow.
+ */
+void GridFluidSolver::AdvectVelocity(float deltaTime) {
+    const glm::ivec3& n = m_settings.resolution;
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3 position = m_velocity.GetSamplePosition(x, y, z) - m_velocity.At(x, y, z) * deltaTime;
+                    m_advectedVelocity.At(x, y, z) = m_velocity.Sample(position);
+                }
+            }
+        }
+    });
+    // Swapping contents keeps m_velocity's address, which affectors point at.
+    std::swap(m_velocity, m_advectedVelocity);
+    ClearBoundaryVelocity();
+}
+
+/**
+ * Moves the smoke along the velocity field.
+ */
+void GridFluidSolver::AdvectDensity(float deltaTime) {
+    const glm::ivec3& n = m_settings.resolution;
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3 position = m_density.GetSamplePosition(x, y, z) - m_velocity.At(x, y, z) * deltaTime;
+                    m_advectedDensity.At(x, y, z) = m_density.Sample(position);
+                }
+            }
+        }
+    });
+    std::swap(m_density, m_advectedDensity);
+}
+
+/**
+ * Makes the velocity divergence free: solves for pressure with Jacobi iterations, then subtracts
+ * its gradient. Walls use zero pressure gradient and zero normal velocity.
+ */
+void GridFluidSolver::Project() {
+    const glm::ivec3& n = m_settings.resolution;
+    float h = m_settings.cellSize;
+    float inverseTwoCells = 0.5f / h;
+
+    auto clampX = [&](int x) { return std::min(std::max(x, 0), n.x - 1); };
+    auto clampY = [&](int y) { return std::min(std::max(y, 0), n.y - 1); };
+    auto clampZ = [&](int z) { return std::min(std::max(z, 0), n.z - 1); };
+
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    float divergence = m_velocity.At(clampX(x + 1), y, z).x - m_velocity.At(clampX(x - 1), y, z).x +
+                                       m_velocity.At(x, clampY(y + 1), z).y - m_velocity.At(x, clampY(y - 1), z).y +
+                                       m_velocity.At(x, y, clampZ(z + 1)).z - m_velocity.At(x, y, clampZ(z - 1)).z;
+                    m_divergence[Index(x, y, z)] = divergence * inverseTwoCells;
+                }
+            }
+        }
+    });
+
+    // Last step's pressure is a good first guess, so few iterations are needed.
+    for (int iteration = 0; iteration < m_settings.pressureIterations; iteration++) {
+        ParallelFor(n.z, 1, [&](int begin, int end) {
+            for (int z = begin; z < end; z++) {
+                for (int y = 0; y < n.y; y++) {
+                    for (int x = 0; x < n.x; x++) {
+                        float neighbors = m_pressure[Index(clampX(x + 1), y, z)] + m_pressure[Index(clampX(x - 1), y, z)] +
+                                          m_pressure[Index(x, clampY(y + 1), z)] + m_pressure[Index(x, clampY(y - 1), z)] +
+                                          m_pressure[Index(x, y, clampZ(z + 1))] + m_pressure[Index(x, y, clampZ(z - 1))];
+                        m_nextPressure[Index(x, y, z)] = (neighbors - m_divergence[Index(x, y, z)] * h * h) / 6.0f;
+                    }
+                }
+            }
+        });
+        std::swap(m_pressure, m_nextPressure);
+    }
+
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3 gradient(m_pressure[Index(clampX(x + 1), y, z)] - m_pressure[Index(clampX(x - 1), y, z)],
+                                       m_pressure[Index(x, clampY(y + 1), z)] - m_pressure[Index(x, clampY(y - 1), z)],
+                                       m_pressure[Index(x, y, clampZ(z + 1))] - m_pressure[Index(x, y, clampZ(z - 1))]);
+                    m_velocity.At(x, y, z) -= gradient * inverseTwoCells;
+                }
+            }
+        }
+    });
+    ClearBoundaryVelocity();
+}
+
+/**
+ * Stops flow through the walls of the grid.
+ */
+void GridFluidSolver::ClearBoundaryVelocity() {
+    const glm::ivec3& n = m_settings.resolution;
+    ParallelFor(n.z, 1, [&](int begin, int end) {
+        for (int z = begin; z < end; z++) {
+            for (int y = 0; y < n.y; y++) {
+                for (int x = 0; x < n.x; x++) {
+                    glm::vec3& velocity = m_velocity.At(x, y, z);
+                    if (x == 0 || x == n.x - 1) velocity.x = 0.0f;
+                    if (y == 0 || y == n.y - 1) velocity.y = 0.0f;
+                    if (z == 0 || z == n.z - 1) velocity.z = 0.0f;
+                }
+            }
+        }
+    });
+}
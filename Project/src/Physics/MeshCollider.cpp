@@ -0,0 +1,293 @@
+// MeshCollider.cpp - Source file for static triangle mesh collision through a BVH.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "../include/Physics/MeshCollider.hpp"
+#include "../include/Particles/Collider.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+static const int COLLIDE_GRAIN_SIZE = 1024;
+static const int MAX_BVH_DEPTH = 64;
+
+/**
+ * Parses the vertex index of an OBJ face element ("7", "7/1", "7//3" or "7/1/3"). Negative
+ * indices count back from the last vertex read.
+ */
+static int ParseFaceIndex(const std::string& element, int numVertices) {
+    int index = std::atoi(element.c_str());
+    return index < 0 ? numVertices + index : index - 1;
+}
+
+/**
+ * Reads the vertices and faces of an OBJ file as triangles.
+ */
+bool LoadOBJTriangles(const std::string& fileName, const glm::mat4& transform,
+                      std::vector<glm::vec3>& vertices, std::vector<int>& indices) {
+    std::ifstream file(fileName.c_str());
+    if (!file.is_open()) {
+        std::cout << "Could not open mesh " << fileName << std::endl;
+        return false;
+    }
+
+    vertices.clear();
+    indices.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string keyword;
+        stream >> keyword;
+
+        if (keyword == "v") {
+            glm::vec3 v;
+            stream >> v.x >> v.y >> v.z;
+            vertices.push_back(glm::vec3(transform * glm::vec4(v, 1.0f)));
+        } else if (keyword == "f") {
+            std::vector<int> face;
+            std::string element;
+            while (stream >> element) {
+                face.push_back(ParseFaceIndex(element, vertices.size()));
+            }
+            for (size_t k = 2; k < face.size(); k++) {
+                indices.push_back(face[0]);
+                indices.push_back(face[k - 1]);
+                indices.push_back(face[k]);
+            }
+        }
+    }
+
+    for (int index : indices) {
+        if (index < 0 || index >= (int)vertices.size()) {
+            std::cout << "Mesh " << fileName << " has an out of range face index" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Loads the vertices and faces of an OBJ file and builds the hierarchy.
+ */
+bool MeshCollider::LoadOBJ(const std::string& fileName, const glm::mat4& transform) {
+    std::vector<glm::vec3> vertices;
+    std::vector<int> indices;
+    if (!LoadOBJTriangles(fileName, transform, vertices, indices)) {
+        return false;
+    }
+
+    SetTriangles(vertices, indices);
+    return true;
+}
+
+/**
+ * Replaces the mesh with the given triangles and rebuilds the hierarchy.
+ */
+void MeshCollider::SetTriangles(const std::vector<glm::vec3>& vertices, const std::vector<int>& indices) {
+    std::vector<BuildTriangle> triangles(indices.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        triangles[t].a = vertices[indices[3 * t + 0]];
+        triangles[t].b = vertices[indices[3 * t + 1]];
+        triangles[t].c = vertices[indices[3 * t + 2]];
+        triangles[t].centroid = (triangles[t].a + triangles[t].b + triangles[t].c) / 3.0f;
+    }
+
+    m_numTriangles = triangles.size();
+    m_nodes.clear();
+    m_packets.clear();
+    if (!triangles.empty()) {
+        m_nodes.reserve(2 * (triangles.size() / TRIANGLE_PACKET_WIDTH + 1));
+        m_nodes.push_back(BVHNode());
+        BuildNode(0, triangles, 0, triangles.size());
+    }
+}
+
+/**
+ * Fills in node nodeIndex over triangles [begin, end), splitting at the median centroid along the
+ * widest axis. Ranges of up to four triangles become a leaf holding one packet.
+ */
+void MeshCollider::BuildNode(int nodeIndex, std::vector<BuildTriangle>& triangles, int begin, int end) {
+    glm::vec3 boundsMin(INFINITY), boundsMax(-INFINITY);
+    glm::vec3 centroidMin(INFINITY), centroidMax(-INFINITY);
+    for (int t = begin; t < end; t++) {
+        boundsMin = glm::min(boundsMin, glm::min(triangles[t].a, glm::min(triangles[t].b, triangles[t].c)));
+        boundsMax = glm::max(boundsMax, glm::max(triangles[t].a, glm::max(triangles[t].b, triangles[t].c)));
+        centroidMin = glm::min(centroidMin, triangles[t].centroid);
+        centroidMax = glm::max(centroidMax, triangles[t].centroid);
+    }
+    m_nodes[nodeIndex].boundsMin = boundsMin;
+    m_nodes[nodeIndex].boundsMax = boundsMax;
+
+    if (end - begin <= TRIANGLE_PACKET_WIDTH) {
+        TrianglePacket packet = {};
+        for (int lane = 0; lane < end - begin; lane++) {
+            const BuildTriangle& triangle = triangles[begin + lane];
+            glm::vec3 e1 = triangle.b - triangle.a;
+            glm::vec3 e2 = triangle.c - triangle.a;
+            packet.v0x[lane] = triangle.a.x; packet.v0y[lane] = triangle.a.y; packet.v0z[lane] = triangle.a.z;
+            packet.e1x[lane] = e1.x; packet.e1y[lane] = e1.y; packet.e1z[lane] = e1.z;
+            packet.e2x[lane] = e2.x; packet.e2y[lane] = e2.y; packet.e2z[lane] = e2.z;
+        }
+        m_nodes[nodeIndex].packet = m_packets.size();
+        m_nodes[nodeIndex].leftChild = -1;
+        m_packets.push_back(packet);
+        return;
+    }
+
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = 0;
+    if (extent.y > extent[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent[axis]) {
+        axis = 2;
+    }
+    int middle = begin + (end - begin) / 2;
+    std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+                     [axis](const BuildTriangle& lhs, const BuildTriangle& rhs) {
+                         return lhs.centroid[axis] < rhs.centroid[axis];
+                     });
+
+    // Children are allocated as a pair so a node only needs the left child's index.
+    int left = m_nodes.size();
+    m_nodes[nodeIndex].leftChild = left;
+    m_nodes[nodeIndex].packet = -1;
+    m_nodes.push_back(BVHNode());
+    m_nodes.push_back(BVHNode());
+    BuildNode(left, triangles, begin, middle);
+    BuildNode(left + 1, triangles, middle, end);
+}
+
+/**
+ * Finds the nearest triangle hit along origin + t * direction for t in [0, hitT]. The packet test
+ * is Moller-Trumbore written lane by lane over structure-of-arrays data, so the compiler can run
+ * all four triangles through the same vector instructions.
+ * 
+ * @param hitT - the segment length on entry; the hit parameter on a hit.
+ * @param hitNormal - the normal of the hit triangle, facing against the direction.
+ * @return - whether anything was hit.
+ */
+bool MeshCollider::Raycast(const glm::vec3& origin, const glm::vec3& direction, float& hitT, glm::vec3& hitNormal) const {
+    const glm::vec3 inverseDirection = 1.0f / direction;
+    bool hit = false;
+    int hitPacket = -1;
+    int hitLane = 0;
+
+    int stack[MAX_BVH_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = m_nodes[stack[--stackSize]];
+
+        // Slab test of the segment against the node bounds.
+        glm::vec3 t0 = (node.boundsMin - origin) * inverseDirection;
+        glm::vec3 t1 = (node.boundsMax - origin) * inverseDirection;
+        glm::vec3 tNear = glm::min(t0, t1);
+        glm::vec3 tFar = glm::max(t0, t1);
+        float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, hitT));
+        if (enter > exit) {
+            continue;
+        }
+
+        if (node.packet < 0) {
+            if (stackSize + 2 <= MAX_BVH_DEPTH) {
+                stack[stackSize++] = node.leftChild + 1;
+                stack[stackSize++] = node.leftChild;
+            }
+            continue;
+        }
+
+        const TrianglePacket& packet = m_packets[node.packet];
+        float laneT[TRIANGLE_PACKET_WIDTH];
+        for (int lane = 0; lane < TRIANGLE_PACKET_WIDTH; lane++) {
+            // p = direction x e2
+            float px = direction.y * packet.e2z[lane] - direction.z * packet.e2y[lane];
+            float py = direction.z * packet.e2x[lane] - direction.x * packet.e2z[lane];
+            float pz = direction.x * packet.e2y[lane] - direction.y * packet.e2x[lane];
+            float determinant = packet.e1x[lane] * px + packet.e1y[lane] * py + packet.e1z[lane] * pz;
+            float inverseDeterminant = 1.0f / determinant;
+
+            float sx = origin.x - packet.v0x[lane];
+            float sy = origin.y - packet.v0y[lane];
+            float sz = origin.z - packet.v0z[lane];
+            float u = (sx * px + sy * py + sz * pz) * inverseDeterminant;
+
+            // q = s x e1
+            float qx = sy * packet.e1z[lane] - sz * packet.e1y[lane];
+            float qy = sz * packet.e1x[lane] - sx * packet.e1z[lane];
+            float qz = sx * packet.e1y[lane] - sy * packet.e1x[lane];
+            float v = (direction.x * qx + direction.y * qy + direction.z * qz) * inverseDeterminant;
+            float t = (packet.e2x[lane] * qx + packet.e2y[lane] * qy + packet.e2z[lane] * qz) * inverseDeterminant;
+
+            bool inside = std::fabs(determinant) > 1e-12f && u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f;
+            laneT[lane] = inside ? t : INFINITY;
+        }
+        for (int lane = 0; lane < TRIANGLE_PACKET_WIDTH; lane++) {
+            if (laneT[lane] <= hitT) {
+                hitT = laneT[lane];
+                hitPacket = node.packet;
+                hitLane = lane;
+                hit = true;
+            }
+        }
+    }
+
+    if (hit) {
+        const TrianglePacket& packet = m_packets[hitPacket];
+        glm::vec3 e1(packet.e1x[hitLane], packet.e1y[hitLane], packet.e1z[hitLane]);
+        glm::vec3 e2(packet.e2x[hitLane], packet.e2y[hitLane], packet.e2z[hitLane]);
+        hitNormal = glm::normalize(glm::cross(e1, e2));
+        if (glm::dot(hitNormal, direction) > 0.0f) {
+            hitNormal = -hitNormal;
+        }
+    }
+    return hit;
+}
+
+/**
+ * Collides particles with the mesh along their motion this step. Hit particles are moved back to
+ * the surface and bounce with the mesh's restitution and friction.
+ */
+int MeshCollider::Collide(Particle* particles, const glm::vec3* previousPositions, int count) const {
+    if (m_nodes.empty() || count == 0) {
+        return 0;
+    }
+
+    std::atomic<int> killed(0);
+    ParallelFor(count, COLLIDE_GRAIN_SIZE, [&](int begin, int end) {
+        int localKilled = 0;
+        for (int i = begin; i < end; i++) {
+            Particle& p = particles[i];
+            glm::vec3 start = previousPositions[i];
+            glm::vec3 motion = p.pos - start;
+            if (glm::dot(motion, motion) < 1e-12f) {
+                continue;
+            }
+
+            // Parameterize the segment over [0, 1] so the slab test needs no normalization. It is
+            // extended by the skin width so particles ending just past the surface are still caught.
+            float hitT = 1.0f + m_settings.skinWidth / std::sqrt(glm::dot(motion, motion));
+            glm::vec3 normal;
+            if (!Raycast(start, motion, hitT, normal)) {
+                continue;
+            }
+
+            if (m_settings.killOnContact) {
+                p.life = 0.0f;
+                p.collided = true;
+                localKilled++;
+                continue;
+            }
+
+            p.pos = start + motion * hitT + normal * m_settings.skinWidth;
+            ResolveContact(p, normal, m_settings.restitution, m_settings.friction);
+        }
+        killed += localKilled;
+    });
+    return killed;
+}
@@ -0,0 +1,112 @@
+// ParallelFor.cpp - Source file for the worker thread pool used by the particle simulation.
+
+#include <algorithm>
+
+#include "../include/Physics/ParallelFor.hpp"
+
+// Set on pool threads so nested ParallelFor calls run inline instead of waiting on themselves.
+static thread_local bool t_isWorkerThread = false;
+
+ThreadPool& ThreadPool::Get() {
+    static ThreadPool pool(std::max(0, (int)std::thread::hardware_concurrency() - 1));
+    return pool;
+}
+
+ThreadPool::ThreadPool(int numWorkers) {
+    for (int i = 0; i < numWorkers; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shutdown = true;
+    }
+    m_wakeWorkers.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+/**
+ * Claims chunks of the current job until none are left.
+ */
+void ThreadPool::RunChunks() {
+    while (true) {
+        int begin = m_nextIndex.fetch_add(m_chunkSize);
+        if (begin >= m_count) {
+            return;
+        }
+        (*m_task)(begin, std::min(begin + m_chunkSize, m_count));
+    }
+}
+
+/**
+ * Worker threads sleep until a new job generation is published, help finish it, and report back.
+ * Every worker checks in for every job, so none can still be touching a job after it returns.
+ */
+void ThreadPool::WorkerLoop() {
+    t_isWorkerThread = true;
+    unsigned seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeWorkers.wait(lock, [&] { return m_shutdown || m_jobGeneration != seenGeneration; });
+            if (m_shutdown) {
+                return;
+            }
+            seenGeneration = m_jobGeneration;
+        }
+
+        RunChunks();
+
+        bool lastWorker;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            lastWorker = (--m_pendingWorkers == 0);
+        }
+        if (lastWorker) {
+            m_jobFinished.notify_one();
+        }
+    }
+}
+
+/**
+ * Runs task(begin, end) over [0, count) in chunks of at least grainSize and waits for all of them.
+ */
+void ThreadPool::ParallelFor(int count, int grainSize, const std::function<void(int, int)>& task) {
+    if (count <= 0) {
+        return;
+    }
+
+    // Small jobs, nested calls, and single-core machines run on the calling thread.
+    grainSize = std::max(1, grainSize);
+    if (m_workers.empty() || t_isWorkerThread || count <= grainSize) {
+        task(0, count);
+        return;
+    }
+
+    // Only one job runs at a time; concurrent callers queue here.
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        // Aim for a few chunks per thread so uneven work still balances.
+        m_chunkSize = std::max(grainSize, count / (GetNumThreads() * 4));
+        m_nextIndex.store(0);
+        m_pendingWorkers = (int)m_workers.size();
+        m_jobGeneration++;
+    }
+    m_wakeWorkers.notify_all();
+
+    RunChunks();
+
+    // Wait for every worker to check in before the task goes out of scope.
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobFinished.wait(lock, [&] { return m_pendingWorkers == 0; });
+    m_task = nullptr;
+}
@@ -0,0 +1,120 @@
+// SDFCollider.cpp - Source file for collision against baked signed distance fields.
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "../include/Physics/SDFCollider.hpp"
+#include "../include/Particles/Collider.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+static const int SDF_GRAIN_SIZE = 2048;
+
+struct SDFFileHeader {
+    char magic[4];
+    int32_t dimensions[3];
+    float origin[3];
+    float cellSize;
+};
+
+/**
+ * Loads a distance field from a file.
+ */
+bool SDFCollider::Load(const std::string& fileName) {
+    std::ifstream file(fileName.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Could not open signed distance field " << fileName << std::endl;
+        return false;
+    }
+
+    file.seekg(0, std::ios::end);
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    // NaN and infinite placements pass the ordered comparisons, so they are checked separately.
+    SDFFileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, "SDF1", 4) != 0 ||
+        header.dimensions[0] < 2 || header.dimensions[1] < 2 || header.dimensions[2] < 2 ||
+        !(header.cellSize > 0.0f) || !std::isfinite(header.cellSize) || !std::isfinite(header.origin[0]) ||
+        !std::isfinite(header.origin[1]) || !std::isfinite(header.origin[2])) {
+        std::cout << "Signed distance field " << fileName << " has an invalid header" << std::endl;
+        return false;
+    }
+
+    // Check each dimension against the samples the file can hold before allocating, so a hostile
+    // header can neither wrap the sample count nor demand more memory than the file could fill.
+    glm::ivec3 dimensions(header.dimensions[0], header.dimensions[1], header.dimensions[2]);
+    size_t available = (size_t)(fileSize - (std::streamoff)sizeof(header)) / sizeof(float);
+    for (int axis = 0; axis < 3; axis++) {
+        if ((size_t)dimensions[axis] > available) {
+            std::cout << "Signed distance field " << fileName << " is truncated" << std::endl;
+            return false;
+        }
+        available /= dimensions[axis];
+    }
+
+    glm::vec3 origin(header.origin[0], header.origin[1], header.origin[2]);
+    m_distances.Allocate(dimensions, origin, header.cellSize);
+
+    size_t numSamples = (size_t)dimensions.x * dimensions.y * dimensions.z;
+    if (!file.read(reinterpret_cast<char*>(m_distances.GetData()), numSamples * sizeof(float))) {
+        std::cout << "Signed distance field " << fileName << " is truncated" << std::endl;
+        m_distances = FieldVolume<float>();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the outward surface normal at a position from the central-difference gradient.
+ */
+glm::vec3 SDFCollider::GetNormal(const glm::vec3& position) const {
+    float h = 0.5f * m_distances.GetCellSize();
+    glm::vec3 gradient(GetDistance(position + glm::vec3(h, 0.0f, 0.0f)) - GetDistance(position - glm::vec3(h, 0.0f, 0.0f)),
+                       GetDistance(position + glm::vec3(0.0f, h, 0.0f)) - GetDistance(position - glm::vec3(0.0f, h, 0.0f)),
+                       GetDistance(position + glm::vec3(0.0f, 0.0f, h)) - GetDistance(position - glm::vec3(0.0f, 0.0f, h)));
+    float length = glm::length(gradient);
+    return length > 1e-8f ? gradient / length : glm::vec3(0.0f, 1.0f, 0.0f);
+}
+
+/**
+ * Pushes particles inside the solid back to its surface and bounces them. Particles outside the
+ * sampled region never collide.
+ */
+int SDFCollider::Collide(Particle* particles, int count) const {
+    if (m_distances.IsEmpty() || count == 0) {
+        return 0;
+    }
+
+    std::atomic<int> killed(0);
+    ParallelFor(count, SDF_GRAIN_SIZE, [&](int begin, int end) {
+        int localKilled = 0;
+        for (int i = begin; i < end; i++) {
+            Particle& p = particles[i];
+            if (!m_distances.Contains(p.pos)) {
+                continue;
+            }
+            float distance = GetDistance(p.pos);
+            if (distance >= m_settings.thickness) {
+                continue;
+            }
+
+            if (m_settings.killOnContact) {
+                p.life = 0.0f;
+                p.collided = true;
+                localKilled++;
+                continue;
+            }
+
+            // The field is close to a true distance, so one step along the normal reaches the surface.
+            glm::vec3 normal = GetNormal(p.pos);
+            p.pos += normal * (m_settings.thickness - distance);
+            ResolveContact(p, normal, m_settings.restitution, m_settings.friction);
+        }
+        killed += localKilled;
+    });
+    return killed;
+}
@@ -0,0 +1,112 @@
+// SPHSolver.cpp - Source file for the smoothed-particle hydrodynamics fluid solver.
+
+#include <algorithm>
+#include <cmath>
+
+#include "../include/Physics/SPHSolver.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+static const float PI = 3.14159265358979f;
+static const int SPH_GRAIN_SIZE = 1024;
+
+/**
+ * Advances the fluid by deltaTime: pressure and viscosity forces, integration, and container walls.
+ */
+void SPHSolver::Step(Particle* particles, int count, SpatialGrid& grid, float deltaTime) {
+    if (count == 0) {
+        return;
+    }
+
+    const SPHSettings& s = m_settings;
+    const float h = s.smoothingRadius;
+    const float h2 = h * h;
+
+    // Kernel normalization constants, computed once per step.
+    const float poly6 = 315.0f / (64.0f * PI * std::pow(h, 9.0f));
+    const float spikyGradient = -45.0f / (PI * std::pow(h, 6.0f));
+    const float viscosityLaplacian = 45.0f / (PI * std::pow(h, 6.0f));
+
+    m_velocities.resize(count);
+    m_densities.resize(count);
+    m_pressures.resize(count);
+    m_accelerations.resize(count);
+
+    int substeps = std::max(1, s.substeps);
+    float dt = deltaTime / substeps;
+
+    for (int step = 0; step < substeps; step++) {
+        grid.Build(particles, count, h);
+        const std::vector<int>& sortedIndices = grid.GetSortedIndices();
+        const std::vector<glm::vec3>& positions = grid.GetSortedPositions();
+
+        // Gather velocities into grid order.
+        ParallelFor(count, SPH_GRAIN_SIZE, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                m_velocities[i] = particles[sortedIndices[i]].speed;
+            }
+        });
+
+        // Density and pressure.
+        ParallelFor(count, SPH_GRAIN_SIZE, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                float density = 0.0f;
+                grid.ForEachNeighborSlot(positions[i], h, [&](uint32_t, float r2) {
+                    float diff = h2 - r2;
+                    density += diff * diff * diff;
+                });
+                density *= s.particleMass * poly6;
+                m_densities[i] = density;
+                // Clamping negative pressure avoids the clumping caused by tensile instability.
+                m_pressures[i] = std::max(0.0f, s.stiffness * (density - s.restDensity));
+            }
+        });
+
+        // Pressure and viscosity accelerations.
+        ParallelFor(count, SPH_GRAIN_SIZE, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                glm::vec3 pressureForce(0.0f);
+                glm::vec3 viscosityForce(0.0f);
+                const glm::vec3 position = positions[i];
+                const glm::vec3 velocity = m_velocities[i];
+                const float pressure = m_pressures[i];
+
+                grid.ForEachNeighborSlot(position, h, [&](uint32_t j, float r2) {
+                    if (j == (uint32_t)i) {
+                        return;
+                    }
+                    float r = std::sqrt(r2);
+                    float inverseDensity = 1.0f / m_densities[j];
+                    float diff = h - r;
+
+                    // Coincident particles get no pressure direction; viscosity still couples them.
+                    if (r > 1e-6f) {
+                        glm::vec3 direction = (position - positions[j]) / r;
+                        pressureForce -= direction * ((pressure + m_pressures[j]) * 0.5f * inverseDensity * spikyGradient * diff * diff);
+                    }
+                    viscosityForce += (m_velocities[j] - velocity) * (inverseDensity * viscosityLaplacian * diff);
+                });
+
+                m_accelerations[i] = (pressureForce + viscosityForce * s.viscosity) * (s.particleMass / m_densities[i]);
+            }
+        });
+
+        // Integrate and keep particles inside the container.
+        ParallelFor(count, SPH_GRAIN_SIZE, [&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                Particle& p = particles[sortedIndices[i]];
+                p.speed = m_velocities[i] + m_accelerations[i] * dt;
+                p.pos += p.speed * dt;
+
+                for (int axis = 0; axis < 3; axis++) {
+                    if (p.pos[axis] < s.boundsMin[axis]) {
+                        p.pos[axis] = s.boundsMin[axis];
+                        p.speed[axis] = std::abs(p.speed[axis]) * s.boundaryRestitution;
+                    } else if (p.pos[axis] > s.boundsMax[axis]) {
+                        p.pos[axis] = s.boundsMax[axis];
+                        p.speed[axis] = -std::abs(p.speed[axis]) * s.boundaryRestitution;
+                    }
+                }
+            }
+        });
+    }
+}
@@ -0,0 +1,69 @@
+// SpatialGrid.cpp - Source file for the uniform-grid spatial hash used for particle neighbor queries.
+
+#include <cmath>
+
+#include "../include/Physics/SpatialGrid.hpp"
+#include "../include/Physics/ParallelFor.hpp"
+
+// Particles per parallel chunk; below this the threading overhead dominates.
+static const int GRID_GRAIN_SIZE = 4096;
+
+/**
+ * Rebuilds the grid with a parallel counting sort: hash every particle, count bucket sizes
+ * with atomics (remembering each particle's rank inside its bucket), prefix-sum the counts,
+ * and scatter particles to their final slots.
+ */
+void SpatialGrid::Build(const Particle* particles, int count, float cellSize) {
+    m_numParticles = count;
+    m_cellSize = cellSize;
+    m_inverseCellSize = 1.0f / cellSize;
+
+    // Use a power-of-two table with about two buckets per particle to keep collisions rare.
+    uint32_t tableSize = 1;
+    while (tableSize < (uint32_t)count * 2) {
+        tableSize <<= 1;
+    }
+    m_tableMask = tableSize - 1;
+
+    if (m_bucketCountsSize < tableSize) {
+        m_bucketCounts.reset(new std::atomic<uint32_t>[tableSize]);
+        m_bucketCountsSize = tableSize;
+    }
+    m_bucketStart.resize(tableSize + 1);
+    m_particleBucket.resize(count);
+    m_particleRank.resize(count);
+    m_sortedIndices.resize(count);
+    m_sortedPositions.resize(count);
+
+    ParallelFor(tableSize, GRID_GRAIN_SIZE, [&](int begin, int end) {
+        for (int b = begin; b < end; b++) {
+            m_bucketCounts[b].store(0, std::memory_order_relaxed);
+        }
+    });
+
+    // Hash and count.
+    ParallelFor(count, GRID_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            uint32_t bucket = HashCell(GetCell(particles[i].pos));
+            m_particleBucket[i] = bucket;
+            m_particleRank[i] = m_bucketCounts[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Exclusive prefix sum of the bucket sizes.
+    uint32_t running = 0;
+    for (uint32_t b = 0; b < tableSize; b++) {
+        m_bucketStart[b] = running;
+        running += m_bucketCounts[b].load(std::memory_order_relaxed);
+    }
+    m_bucketStart[tableSize] = running;
+
+    // Scatter.
+    ParallelFor(count, GRID_GRAIN_SIZE, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            uint32_t slot = m_bucketStart[m_particleBucket[i]] + m_particleRank[i];
+            m_sortedIndices[slot] = i;
+            m_sortedPositions[slot] = particles[i].pos;
+        }
+    });
+}
@@ -0,0 +1,60 @@
+// VectorField.cpp - Source file for velocity and force fields loaded from disk.
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "../include/Physics/VectorField.hpp"
+
+struct VectorFieldFileHeader {
+    char magic[4];
+    int32_t dimensions[3];
+    float origin[3];
+    float cellSize;
+};
+
+/**
+ * Maps a field file and points the volume at the vectors inside the mapping.
+ */
+bool VectorField::Load(const std::string& fileName) {
+    m_volume = FieldVolume<glm::vec3>();
+    if (!m_file.Open(fileName)) {
+        return false;
+    }
+
+    VectorFieldFileHeader header;
+    if (m_file.GetSize() < sizeof(header)) {
+        std::cout << "Vector field " << fileName << " is too small for its header" << std::endl;
+        m_file.Close();
+        return false;
+    }
+    std::memcpy(&header, m_file.GetData(), sizeof(header));
+
+    // NaN and infinite placements pass the ordered comparisons, so they are checked separately.
+    if (std::memcmp(header.magic, "VEC1", 4) != 0 || header.dimensions[0] < 1 || header.dimensions[1] < 1 ||
+        header.dimensions[2] < 1 || !(header.cellSize > 0.0f) || !std::isfinite(header.cellSize) ||
+        !std::isfinite(header.origin[0]) || !std::isfinite(header.origin[1]) || !std::isfinite(header.origin[2])) {
+        std::cout << "Vector field " << fileName << " has an invalid header" << std::endl;
+        m_file.Close();
+        return false;
+    }
+
+    // Check each dimension against the samples the file can hold before multiplying them, so a
+    // hostile header cannot overflow the sample count past the truncation check.
+    glm::ivec3 dimensions(header.dimensions[0], header.dimensions[1], header.dimensions[2]);
+    size_t available = (m_file.GetSize() - sizeof(header)) / sizeof(glm::vec3);
+    for (int axis = 0; axis < 3; axis++) {
+        if ((size_t)dimensions[axis] > available) {
+            std::cout << "Vector field " << fileName << " is truncated" << std::endl;
+            m_file.Close();
+            return false;
+        }
+        available /= dimensions[axis];
+    }
+
+    // The header is 32 bytes, so the vectors that follow are float aligned inside the page-aligned mapping.
+    const glm::vec3* vectors = reinterpret_cast<const glm::vec3*>(m_file.GetData() + sizeof(header));
+    m_volume.SetExternalData(vectors, dimensions, glm::vec3(header.origin[0], header.origin[1], header.origin[2]), header.cellSize);
+    return true;
+}
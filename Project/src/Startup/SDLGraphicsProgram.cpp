@@ -1,9 +1,11 @@
 #include <SDL2/SDL.h>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
 #include "../../include/Startup/SDLGraphicsProgram.hpp"
+#include "../../include/Physics/CurlNoise.hpp"
 #include "Globals.hpp"
 
 Uint32 previousTime = 0;
@@ -57,7 +59,19 @@ SDLGraphicsProgram::SDLGraphicsProgram(int windowHeight, int windowWidth) {
     // ObjectManager* objectManager = new ObjectManager();
     // RenderingManager* renderingManager = new RenderingManager(objectManager);
     // m_renderingManager = renderingManager;
-    m_particleEmitter = new ParticleEmitter();
+    // Create the per-frame camera uniform buffer. It stays bound for every program that reads FrameData.
+    glGenBuffers(1, &m_frameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, m_frameUniformBuffer);
+
+    m_emitterManager = new EmitterManager();
+    ParticleEmitter* fountain = m_emitterManager->CreateEmitter(glm::vec3(0.0f, 0.0f, -5.0f));
+    // Catch the fountain on a floor just below the nozzle.
+    fountain->AddCollider(Collider::Plane(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.3f, 0.4f));
+
+    // Precompute the turbulence volume once; it repeats every 16 units.
+    GenerateCurlNoise(m_turbulence, 32, 0.5f);
 
     g.gCamera.SetCameraEyePosition(0.0, 5.0, 25.0f);
 }
@@ -66,6 +80,11 @@ SDLGraphicsProgram::SDLGraphicsProgram(int windowHeight, int windowWidth) {
  * Destructs the SDL window and quits SDL.
  */
 SDLGraphicsProgram::~SDLGraphicsProgram() {   
+    delete m_emitterManager;
+    m_emitterManager = nullptr;
+
+    if (m_frameUniformBuffer) glDeleteBuffers(1, &m_frameUniformBuffer);
+
     SDL_DestroyWindow(m_window);
     m_window = nullptr;
 
@@ -115,6 +134,129 @@ void SDLGraphicsProgram::Input() {
         if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) {
             m_quit = true;
         } 
+        // Toggle order-independent transparency on "6". Handled as an event so holding the key toggles once.
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_6) {
+            m_emitterManager->ToggleOrderIndependentTransparency();
+        }
+        // Cycle every emitter's blend mode on "7".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_7) {
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                int nextMode = ((int)emitter->GetBlendMode() + 1) % (int)BlendMode::Count;
+                emitter->SetBlendMode((BlendMode)nextMode);
+            }
+        }
+        // Cycle every emitter's simulation mode on "8".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_8) {
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                int nextMode = ((int)emitter->GetSimulationMode() + 1) % (int)SimulationMode::Count;
+                emitter->SetSimulationMode((SimulationMode)nextMode);
+            }
+        }
+        // Hang a rope from above the fountain on "9".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_9) {
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                emitter->AddRope(glm::vec3(-4.0f, 8.0f, 0.0f), glm::vec3(4.0f, 8.0f, 0.0f), 40, true, true);
+            }
+        }
+        // Toggle a GPU-simulated fountain that collides with the opaque scene's depth on "0".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_0) {
+            if (m_emitterManager->GetGPUEmitters().empty()) {
+                m_emitterManager->CreateGPUEmitter(glm::vec3(6.0f, 0.0f, -5.0f));
+            } else {
+                m_emitterManager->DestroyGPUEmitter(m_emitterManager->GetGPUEmitters().back());
+            }
+        }
+        // Toggle curl-noise turbulence on every emitter on "t".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_t) {
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                std::vector<Affector>& affectors = emitter->GetAffectors();
+                auto turbulence = std::find_if(affectors.begin(), affectors.end(), [](const Affector& affector) {
+                    return affector.type == AffectorType::Turbulence;
+                });
+                if (turbulence != affectors.end()) {
+                    affectors.erase(turbulence);
+                } else {
+                    emitter->AddAffector(Affector::Turbulence(&m_turbulence, 12.0f));
+                }
+            }
+        }
+        // Toggle a smoky cross wind simulated on a grid around the fountain on "f".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_f) {
+            if (m_gridFluid == nullptr) {
+                m_gridFluid = m_emitterManager->CreateGridFluid();
+                m_gridFluid->AddSource({ glm::vec3(-4.5f, 1.0f, 0.0f), 1.0f, glm::vec3(6.0f, 0.0f, 0.0f), 1.0f });
+                for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                    emitter->AddAffector(Affector::FlowField(&m_gridFluid->GetVelocity(), 2.0f));
+                }
+            } else {
+                // Drop the affectors before the volume they sample goes away.
+                for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                    std::vector<Affector>& affectors = emitter->GetAffectors();
+                    affectors.erase(std::remove_if(affectors.begin(), affectors.end(), [this](const Affector& affector) {
+                        return affector.field == &m_gridFluid->GetVelocity();
+                    }), affectors.end());
+                }
+                m_emitterManager->DestroyGridFluid(m_gridFluid);
+                m_gridFluid = nullptr;
+            }
+        }
+        // Cycle every emitter through the analytic emission shapes on "e".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_e) {
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                glm::vec3 up(0.0f, 1.0f, 0.0f);
+                switch (emitter->GetEmissionShape().type) {
+                    case EmissionShapeType::Cone:
+                        emitter->SetEmissionShape(EmissionShape::Sphere(glm::vec3(0.0f, 2.0f, 0.0f), 1.5f, 4.0f));
+                        break;
+                    case EmissionShapeType::Sphere:
+                        emitter->SetEmissionShape(EmissionShape::Hemisphere(glm::vec3(0.0f), up, 1.5f, 6.0f, true));
+                        break;
+                    case EmissionShapeType::Hemisphere:
+                        emitter->SetEmissionShape(EmissionShape::Box(glm::vec3(0.0f), glm::vec3(2.0f, 0.25f, 2.0f), up, 8.0f));
+                        break;
+                    case EmissionShapeType::Box:
+                        emitter->SetEmissionShape(EmissionShape::Disc(glm::vec3(0.0f), up, 2.0f, 8.0f));
+                        break;
+                    case EmissionShapeType::Disc:
+                        emitter->SetEmissionShape(EmissionShape::Line(glm::vec3(-3.0f, 0.0f, 0.0f), glm::vec3(3.0f, 0.0f, 0.0f), up, 8.0f));
+                        break;
+                    default:
+                        emitter->SetEmissionShape(EmissionShape::Cone());
+                        break;
+                }
+            }
+        }
+        // Toggle a fade-in, cool-down and grow lifetime curve on every emitter on "c".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_c) {
+            LifetimeCurves curves;
+            curves.colorKeys = { { 0.0f, glm::vec4(1.0f, 1.0f, 1.0f, 0.0f) }, { 0.1f, glm::vec4(1.0f) },
+                                 { 0.7f, glm::vec4(1.0f, 0.6f, 0.2f, 1.0f) }, { 1.0f, glm::vec4(0.3f, 0.1f, 0.1f, 0.0f) } };
+            curves.sizeKeys = { { 0.0f, 0.3f }, { 0.2f, 1.0f }, { 1.0f, 2.0f } };
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                emitter->SetLifetimeCurves(emitter->HasLifetimeCurves() ? LifetimeCurves() : curves);
+            }
+        }
+        // Toggle trails behind every emitter's particles on "r".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_r) {
+            for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+                emitter->EnableTrails(emitter->GetTrailLength() > 0 ? 0 : 12);
+            }
+        }
+        // Toggle splashes where the fountain's particles hit the floor on "b".
+        if (event.type == SDL_KEYDOWN && !event.key.repeat && event.key.keysym.sym == SDLK_b) {
+            ParticleEmitter* fountain = m_emitterManager->GetEmitters().front();
+            if (m_splashEmitter == nullptr) {
+                m_splashEmitter = m_emitterManager->CreateEmitter(fountain->GetPosition(), 50000);
+                m_splashEmitter->SetEmissionRate(0.0f);
+                m_splashEmitter->SetBlendMode(BlendMode::Additive);
+                m_splashEmitter->AddCollider(Collider::Plane(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.3f, 0.4f));
+                m_splashEmitter->AddSubEmitterSource({ fountain, ParticleEventType::Collision, 4, 3.0f, 0.3f });
+            } else {
+                m_emitterManager->DestroyEmitter(m_splashEmitter);
+                m_splashEmitter = nullptr;
+                fountain->SetEventCapacity(ParticleEventType::Collision, 0);
+            }
+        }
         if(event.type==SDL_MOUSEMOTION){
             // Capture the change in the mouse position
             mouseX+=event.motion.xrel;
@@ -154,22 +296,44 @@ void SDLGraphicsProgram::Input() {
         m_frustumCullingStatus = !m_frustumCullingStatus;
     }
     if (state[SDL_SCANCODE_2]) {
-        m_particleEmitter->increaseGravity();
+        for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+            emitter->increaseGravity();
+        }
     }
 
     if (state[SDL_SCANCODE_3]) {
-        m_particleEmitter->decreaseGravity();
+        for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+            emitter->decreaseGravity();
+        }
     }
 
     if (state[SDL_SCANCODE_4]) {
-        m_particleEmitter->increaseSpread();
+        for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+            emitter->increaseSpread();
+        }
     }
 
     if (state[SDL_SCANCODE_5]) {
-        m_particleEmitter->decreaseSpread();
+        for (ParticleEmitter* emitter : m_emitterManager->GetEmitters()) {
+            emitter->decreaseSpread();
+        }
     }
 }
 
+/**
+ * Computes this frame's camera matrices and uploads them to the frame uniform buffer.
+ */
+void SDLGraphicsProgram::UpdateFrameUniforms() {
+    FrameUniforms& frame = g.gFrameUniforms;
+    frame.viewMatrix = g.gCamera.GetViewMatrix();
+    frame.projectionMatrix = glm::perspective(glm::radians(45.0f), (float)g.gWindowWidth / (float)g.gWindowHeight, 0.1f, 50.0f);
+    frame.viewProjectionMatrix = frame.projectionMatrix * frame.viewMatrix;
+    frame.cameraPosition = glm::vec4(g.gCamera.GetCameraPosition(), 1.0f);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &frame);
+}
+
 /** 
  * Loops through the program until the user ends it with esc or presses the red x.
  */
@@ -189,10 +353,13 @@ void SDLGraphicsProgram::Loop() {
         // Process input.
         Input();
 
+        // Upload camera data shared by all shaders.
+        UpdateFrameUniforms();
+
         // Update particles and render.
-        m_particleEmitter->UpdateParticles(m_frustumCullingStatus);
-        m_particleEmitter->RenderParticles();
-        int numParticlesRendered = m_particleEmitter->GetNumParticlesRendered();
+        m_emitterManager->UpdateEmitters(m_frustumCullingStatus);
+        m_emitterManager->RenderEmitters();
+        int numParticlesRendered = m_emitterManager->GetNumParticlesRendered();
 
         // Calculate FPS.
         if (deltaTime > 0) {
@@ -1,5 +1,21 @@
 #include "../../include/Startup/Shader.hpp"
 
+#include <filesystem>
+
+const char* Shader::s_programCacheDirectory = "./shaders/cache";
+
+// Identifies a program binary cache file and its layout version.
+static const uint32_t PROGRAM_CACHE_MAGIC = 0x42505350; // "PSPB"
+static const uint32_t PROGRAM_CACHE_VERSION = 1;
+
+struct ProgramCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t binaryFormat;
+    uint32_t binaryLength;
+};
+
 /**
  * Constructor that takes in shader file paths and creates a shader program.
  * 
@@ -53,6 +69,8 @@ GLuint Shader::CompileShader(GLuint type, const std::string &source) {
         shaderObject = glCreateShader(GL_VERTEX_SHADER);
     } else if (GL_FRAGMENT_SHADER == type) {
         shaderObject = glCreateShader(GL_FRAGMENT_SHADER);
+    } else if (GL_COMPUTE_SHADER == type) {
+        shaderObject = glCreateShader(GL_COMPUTE_SHADER);
     }
 
     const char* src = source.c_str();
@@ -75,6 +93,8 @@ GLuint Shader::CompileShader(GLuint type, const std::string &source) {
             std::cout << "Error: GL_VERTEX_SHADER compilation failed: \n" << errorMessages << std::endl;
         } else if (GL_FRAGMENT_SHADER == type) {
             std::cout << "Error: GL_FRAGMENT_SHADER compilation failed: \n" << errorMessages << std::endl;
+        } else if (GL_COMPUTE_SHADER == type) {
+            std::cout << "Error: GL_COMPUTE_SHADER compilation failed: \n" << errorMessages << std::endl;
         }
 
         // Reclaim memory.
@@ -96,9 +116,21 @@ GLuint Shader::CompileShader(GLuint type, const std::string &source) {
  * @return - a GLuint representing our graphics pipeline.
  */
 GLuint Shader::CreateShaderProgram(const std::string &vertexShaderSource, const std::string &fragmentShaderSource) {
+    // Reuse a previously linked binary for these exact sources and driver if one is cached.
+    uint64_t cacheKey = HashProgramSources(vertexShaderSource, fragmentShaderSource);
+    GLuint cachedProgram = LoadProgramBinary(cacheKey);
+    if (cachedProgram) {
+        m_shaderID = cachedProgram;
+        m_uniformLocations.clear();
+        return cachedProgram;
+    }
+
     // Create a new program object.
     GLuint programObject = glCreateProgram();
 
+    // Ask the driver to keep the linked binary around so we can cache it.
+    glProgramParameteri(programObject, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     // Compile our shaders.
     GLuint myVertexShader   = CompileShader(GL_VERTEX_SHADER, vertexShaderSource);
     GLuint myFragmentShader = CompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
@@ -117,6 +149,7 @@ GLuint Shader::CreateShaderProgram(const std::string &vertexShaderSource, const
     }
 
     m_shaderID = programObject;
+    m_uniformLocations.clear();
 
     // Validate our program.
     glValidateProgram(programObject);
@@ -130,9 +163,176 @@ GLuint Shader::CreateShaderProgram(const std::string &vertexShaderSource, const
     glDeleteShader(myVertexShader);
     glDeleteShader(myFragmentShader);
 
+    if (GL_TRUE == params) {
+        SaveProgramBinary(cacheKey, programObject);
+    }
+
+    return programObject;
+}
+
+/**
+ * Creates a compute program from a single compute shader.
+ * 
+ * @param computeShaderSource - the string representation of the shader file from LoadShaderAsString(...).
+ * @return - a GLuint representing the compute program.
+ */
+GLuint Shader::CreateComputeProgram(const std::string &computeShaderSource) {
+    // No graphics program has an empty fragment shader, so compute keys never collide with them.
+    uint64_t cacheKey = HashProgramSources(computeShaderSource, "");
+    GLuint cachedProgram = LoadProgramBinary(cacheKey);
+    if (cachedProgram) {
+        m_shaderID = cachedProgram;
+        m_uniformLocations.clear();
+        return cachedProgram;
+    }
+
+    GLuint programObject = glCreateProgram();
+    glProgramParameteri(programObject, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    GLuint myComputeShader = CompileShader(GL_COMPUTE_SHADER, computeShaderSource);
+    glAttachShader(programObject, myComputeShader);
+    glLinkProgram(programObject);
+
+    // Check if link was successful.
+    int params = -1;
+    glGetProgramiv(programObject, GL_LINK_STATUS, &params);
+    if (GL_TRUE != params) {
+        std::cout << "ERROR: could not link compute programObject GL index " << programObject << std::endl;
+        PrintProgramInfoLog(programObject);
+    }
+
+    m_shaderID = programObject;
+    m_uniformLocations.clear();
+
+    glDetachShader(programObject, myComputeShader);
+    glDeleteShader(myComputeShader);
+
+    if (GL_TRUE == params) {
+        SaveProgramBinary(cacheKey, programObject);
+    }
+
+    return programObject;
+}
+
+/**
+ * Hashes the shader sources together with the driver's vendor, renderer, and version strings.
+ * 
+ * @param vertexShaderSource - the vertex shader source text.
+ * @param fragmentShaderSource - the fragment shader source text.
+ * @return - a 64-bit FNV-1a hash identifying the program binary.
+ */
+uint64_t Shader::HashProgramSources(const std::string &vertexShaderSource, const std::string &fragmentShaderSource) {
+    const GLubyte* vendor = glGetString(GL_VENDOR);
+    const GLubyte* renderer = glGetString(GL_RENDERER);
+    const GLubyte* version = glGetString(GL_VERSION);
+
+    std::string key = vertexShaderSource;
+    key += '\0';
+    key += fragmentShaderSource;
+    key += '\0';
+    key += vendor ? (const char*)vendor : "";
+    key += '\0';
+    key += renderer ? (const char*)renderer : "";
+    key += '\0';
+    key += version ? (const char*)version : "";
+
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * Returns the cache file path for a program binary key.
+ */
+static std::string ProgramCachePath(const char* directory, uint64_t key) {
+    std::stringstream ss;
+    ss << directory << "/" << std::hex << key << ".bin";
+    return ss.str();
+}
+
+/**
+ * Tries to create a program from a cached binary on disk.
+ * 
+ * @param key - the hash from HashProgramSources(...).
+ * @return - a linked program object, or 0 if there is no usable cached binary.
+ */
+GLuint Shader::LoadProgramBinary(uint64_t key) {
+    // Drivers that support no binary formats cannot load anything we saved.
+    GLint numFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+    if (numFormats <= 0) {
+        return 0;
+    }
+
+    std::ifstream file(ProgramCachePath(s_programCacheDirectory, key), std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    ProgramCacheHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != PROGRAM_CACHE_MAGIC || header.version != PROGRAM_CACHE_VERSION || header.key != key) {
+        return 0;
+    }
+
+    std::vector<char> binary(header.binaryLength);
+    if (!file.read(binary.data(), binary.size())) {
+        return 0;
+    }
+
+    GLuint programObject = glCreateProgram();
+    glProgramBinary(programObject, header.binaryFormat, binary.data(), header.binaryLength);
+
+    // The driver may reject a binary (e.g. after an update); fall back to a full compile.
+    int params = -1;
+    glGetProgramiv(programObject, GL_LINK_STATUS, &params);
+    if (GL_TRUE != params) {
+        glDeleteProgram(programObject);
+        return 0;
+    }
+
     return programObject;
 }
 
+/**
+ * Writes a linked program's binary to the cache directory.
+ * 
+ * @param key - the hash from HashProgramSources(...).
+ * @param programObject - a program linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+ */
+void Shader::SaveProgramBinary(uint64_t key, GLuint programObject) {
+    GLint length = 0;
+    glGetProgramiv(programObject, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(programObject, length, &length, &binaryFormat, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(s_programCacheDirectory, error);
+
+    std::ofstream file(ProgramCachePath(s_programCacheDirectory, key), std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cout << "Could not write program binary cache for key " << std::hex << key << std::dec << std::endl;
+        return;
+    }
+
+    ProgramCacheHeader header;
+    header.magic = PROGRAM_CACHE_MAGIC;
+    header.version = PROGRAM_CACHE_VERSION;
+    header.key = key;
+    header.binaryFormat = binaryFormat;
+    header.binaryLength = length;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+}
+
 
 /**
  * Gets the shaderID.
@@ -278,12 +478,25 @@ const char* Shader::GLTypeToString(GLenum type) {
     return "other";
 }
 
-void Shader::SetUniformMatrix4fv(const GLchar* name, const GLfloat* value) {
-    // GLint location = glGetUniformLocation(m_shaderID, name);
-
-    // glUniformMatrix4fv(location, 1, GL_FALSE, value);
+/**
+ * Looks up a uniform location, querying the driver only the first time a name is used.
+ * 
+ * @param name - the name of the uniform in the shader.
+ * @return - the uniform location, or -1 if the program has no such active uniform.
+ */
+GLint Shader::GetUniformLocation(const GLchar* name) {
+    auto it = m_uniformLocations.find(name);
+    if (it != m_uniformLocations.end()) {
+        return it->second;
+    }
 
     GLint location = glGetUniformLocation(m_shaderID, name);
+    m_uniformLocations[name] = location;
+    return location;
+}
+
+void Shader::SetUniformMatrix4fv(const GLchar* name, const GLfloat* value) {
+    GLint location = GetUniformLocation(name);
     if (location >= 0) {
         glUniformMatrix4fv(location,1,GL_FALSE, value);
     }else {
@@ -293,7 +506,7 @@ void Shader::SetUniformMatrix4fv(const GLchar* name, const GLfloat* value) {
 }
 
 void Shader::SetUniform3f(const GLchar* name, float r, float g, float b) {
-    GLint location = glGetUniformLocation(m_shaderID, name);
+    GLint location = GetUniformLocation(name);
 
     glUniform3f(location, r, g, b);
 }